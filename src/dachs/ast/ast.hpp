@@ -4,6 +4,7 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <utility>
 #include <cstddef>
 #include <cassert>
 #include <boost/variant/variant.hpp>
@@ -726,17 +727,37 @@ struct switch_stmt final : public statement {
     }
 };
 
+// Note:
+// Hints for loop optimizations annotated before a loop (e.g. '@unroll(4)').
+// The argument is omitted when the hint only enables the optimization.
+using loop_hint = std::pair<std::string, boost::optional<unsigned int>>;
+using loop_hints = std::vector<loop_hint>;
+
 struct for_stmt final : public statement {
     std::vector<node::parameter> iter_vars;
     node::any_expr range_expr;
     node::statement_block body_stmts;
+    loop_hints hints;
 
     for_stmt(decltype(iter_vars) const& iters,
              node::any_expr const& range,
-             node::statement_block body) noexcept
-        : statement(), iter_vars(iters), range_expr(range), body_stmts(body)
+             node::statement_block body,
+             loop_hints const& hints = {}) noexcept
+        : statement(), iter_vars(iters), range_expr(range), body_stmts(body), hints(hints)
     {}
 
+    // Note:
+    // Iterations of the loop annotated with '@parallel' run concurrently
+    bool is_parallel() const noexcept
+    {
+        for (auto const& h : hints) {
+            if (h.first == "parallel") {
+                return true;
+            }
+        }
+        return false;
+    }
+
     std::string to_string() const noexcept override
     {
         return "FOR_STMT";
@@ -746,10 +767,12 @@ struct for_stmt final : public statement {
 struct while_stmt final : public statement {
     node::any_expr condition;
     node::statement_block body_stmts;
+    loop_hints hints;
 
     while_stmt(node::any_expr const& cond,
-               node::statement_block const& body) noexcept
-        : statement(), condition(cond), body_stmts(body)
+               node::statement_block const& body,
+               loop_hints const& hints = {}) noexcept
+        : statement(), condition(cond), body_stmts(body), hints(hints)
     {}
 
     std::string to_string() const noexcept override
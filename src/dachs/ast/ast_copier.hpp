@@ -11,6 +11,7 @@
 #include "dachs/helper/util.hpp"
 #include "dachs/helper/make.hpp"
 #include "dachs/helper/variant.hpp"
+#include "dachs/statistics.hpp"
 
 namespace dachs {
 namespace ast {
@@ -19,6 +20,7 @@ namespace detail {
 template<class Node, class SourceNode, class... Args>
 inline Node copy_node(SourceNode const& node, Args &&... args)
 {
+    DACHS_STATS_INCREMENT("ast.copied_nodes");
     auto copied = helper::make<Node>(std::forward<Args>(args)...);
     copied->line = node->line;
     copied->col = node->col;
@@ -219,12 +221,12 @@ public:
 
     auto copy(node::for_stmt const& fs) const
     {
-        return copy_node<node::for_stmt>(fs, copy(fs->iter_vars), copy(fs->range_expr), copy(fs->body_stmts));
+        return copy_node<node::for_stmt>(fs, copy(fs->iter_vars), copy(fs->range_expr), copy(fs->body_stmts), fs->hints);
     }
 
     auto copy(node::while_stmt const& ws) const
     {
-        return copy_node<node::while_stmt>(ws, copy(ws->condition), copy(ws->body_stmts));
+        return copy_node<node::while_stmt>(ws, copy(ws->condition), copy(ws->body_stmts), ws->hints);
     }
 
     auto copy(node::postfix_if_stmt const& pif) const
@@ -0,0 +1,182 @@
+#if !defined DACHS_CODEGEN_LLVMIR_BLOCK_INLINER_HPP_INCLUDED
+#define      DACHS_CODEGEN_LLVMIR_BLOCK_INLINER_HPP_INCLUDED
+
+#include <vector>
+#include <unordered_set>
+#include <cstddef>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+namespace dachs {
+namespace codegen {
+namespace llvmir {
+
+// Note:
+// Do-end blocks and lambdas are lowered to functions which receive their captures as
+// a struct.  A function which takes a block as parameter is instantiated for each block
+// because each block has its own type.  So every invocation of a block and every call of
+// such higher-order function has the statically known callee.
+//
+// This inliner
+//   1. inlines invocations of blocks into the instantiated higher-order functions,
+//   2. inlines the higher-order functions into their callers and
+//   3. folds accesses to captures (extractvalue from the capture struct built by
+//      insertvalue) into the captured values themselves.
+// As the result, iteration with a block (e.g. '1.step_to n do |i| ... end') becomes a plain
+// loop in the caller and no closure object is constructed.
+class block_inliner {
+    llvm::DataLayout const* const data_layout;
+    std::vector<llvm::Function *> blocks;
+    std::vector<llvm::Function *> block_receivers;
+    std::unordered_set<llvm::Function *> inlined_into;
+
+    // Note:
+    // Inlining can't terminate on recursion.  Self tail recursion is already converted
+    // to a loop on emitting the function.
+    bool is_recursive(llvm::Function &f) const
+    {
+        for (auto itr = f.use_begin(); itr != f.use_end(); ++itr) {
+            auto *const call = llvm::dyn_cast<llvm::CallInst>(*itr);
+            if (call && call->getParent()->getParent() == &f) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool inline_calls_of(llvm::Function *const f)
+    {
+        if (f->isDeclaration() || is_recursive(*f)) {
+            return false;
+        }
+
+        std::vector<llvm::CallInst *> calls;
+        for (auto itr = f->use_begin(); itr != f->use_end(); ++itr) {
+            auto *const call = llvm::dyn_cast<llvm::CallInst>(*itr);
+            if (call && call->getCalledFunction() == f) {
+                calls.push_back(call);
+            }
+        }
+
+        bool inlined = false;
+        for (auto *const call : calls) {
+            auto *const caller = call->getParent()->getParent();
+            llvm::InlineFunctionInfo info{nullptr, data_layout};
+            if (llvm::InlineFunction(call, info)) {
+                inlined_into.insert(caller);
+                inlined = true;
+            }
+        }
+
+        return inlined;
+    }
+
+    // Note:
+    // Inlined code may include other blocks (e.g. a block invokes another block given to
+    // the enclosing function).  Repeat until no inlinable call remains.
+    void inline_all(std::vector<llvm::Function *> const& targets)
+    {
+        std::size_t const max_iterations = 8u;
+        for (std::size_t i = 0u; i < max_iterations; ++i) {
+            bool changed = false;
+            for (auto *const f : targets) {
+                changed = inline_calls_of(f) || changed;
+            }
+            if (!changed) {
+                return;
+            }
+        }
+    }
+
+    void fold_capture_accesses(llvm::Function &f) const
+    {
+        for (auto &block : f) {
+            for (auto itr = block.begin(); itr != block.end();) {
+                auto *const extract = llvm::dyn_cast<llvm::ExtractValueInst>(&*itr++);
+                if (!extract) {
+                    continue;
+                }
+
+                if (auto *const inserted = llvm::FindInsertedValue(extract->getAggregateOperand(), extract->getIndices())) {
+                    extract->replaceAllUsesWith(inserted);
+                    extract->eraseFromParent();
+                }
+            }
+        }
+
+        // Note:
+        // Remove capture structs which are no longer used
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto &block : f) {
+                for (auto itr = block.begin(); itr != block.end();) {
+                    auto *const insert = llvm::dyn_cast<llvm::InsertValueInst>(&*itr++);
+                    if (insert && insert->use_empty()) {
+                        insert->eraseFromParent();
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    void erase_if_unused(std::vector<llvm::Function *> const& fs) const
+    {
+        for (auto *const f : fs) {
+            if (f->use_empty()) {
+                f->eraseFromParent();
+            }
+        }
+    }
+
+public:
+
+    explicit block_inliner(llvm::DataLayout const* const dl) noexcept
+        : data_layout(dl)
+    {}
+
+    // Note:
+    // Blocks and the functions receiving them are only called in the module.
+    void add_block(llvm::Function *const f)
+    {
+        f->setLinkage(llvm::GlobalValue::InternalLinkage);
+        f->addFnAttr(llvm::Attribute::AlwaysInline);
+        blocks.push_back(f);
+    }
+
+    void add_block_receiver(llvm::Function *const f)
+    {
+        f->setLinkage(llvm::GlobalValue::InternalLinkage);
+        block_receivers.push_back(f);
+    }
+
+    void run()
+    {
+        inline_all(blocks);
+        inline_all(block_receivers);
+
+        // Note:
+        // Blocks given to inlined receivers are invoked in the callers now
+        inline_all(blocks);
+
+        for (auto *const f : inlined_into) {
+            if (!f->isDeclaration()) {
+                fold_capture_accesses(*f);
+            }
+        }
+
+        erase_if_unused(block_receivers);
+        erase_if_unused(blocks);
+    }
+};
+
+} // namespace llvmir
+} // namespace codegen
+} // namespace dachs
+
+#endif    // DACHS_CODEGEN_LLVMIR_BLOCK_INLINER_HPP_INCLUDED
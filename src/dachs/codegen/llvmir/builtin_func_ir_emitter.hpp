@@ -50,41 +50,182 @@ public:
         llvm::Function *target = nullptr;
 
         auto const define_func_prototype =
-            [&](llvm::Type *arg_type_ir)
+            [&](std::vector<llvm::Type *> const& param_types)
             {
-                std::vector<llvm::Type *> param_types
-                    = {arg_type_ir};
                 auto const print_func_type = llvm::FunctionType::get(
                         llvm::StructType::get(context, {}),
                         param_types,
                         false
                     );
-                return llvm::Function::Create(
+                auto *const func = llvm::Function::Create(
                         print_func_type,
                         llvm::Function::ExternalLinkage,
                         prefix + arg_type->name + "__",
                         module
                     );
+                func->addFnAttr(llvm::Attribute::NoUnwind);
+                return func;
             };
 
         assert(module);
         auto const& n = arg_type->name;
-        if (n == "string" || n == "symbol") {
-            target = define_func_prototype(llvm::Type::getInt8PtrTy(context));
+        if (n == "string") {
+            // Note: A string is passed as its pointer and length
+            target = define_func_prototype({llvm::Type::getInt8PtrTy(context), llvm::Type::getInt64Ty(context)});
+        } else if (n == "symbol") {
+            target = define_func_prototype({llvm::Type::getInt8PtrTy(context)});
         } else if (n == "int" || n == "uint") {
-            target = define_func_prototype(llvm::Type::getInt64Ty(context));
+            target = define_func_prototype({llvm::Type::getInt64Ty(context)});
         } else if (n == "float") {
-            target = define_func_prototype(llvm::Type::getDoubleTy(context));
+            target = define_func_prototype({llvm::Type::getDoubleTy(context)});
         } else if (n == "char") {
-            target = define_func_prototype(llvm::Type::getInt8Ty(context));
+            target = define_func_prototype({llvm::Type::getInt8Ty(context)});
         } else if (n == "bool") {
-            target = define_func_prototype(llvm::Type::getInt1Ty(context));
+            target = define_func_prototype({llvm::Type::getInt1Ty(context)});
         }
 
         table.insert(std::make_pair(arg_type->name, target));
         return target;
     }
 
+    // Note:
+    // Declare a function implemented in the runtime library (src/dachs/runtime).
+    llvm::Function *emit_runtime_func(std::string const& name, llvm::Type *const ret_type, std::vector<llvm::Type *> const& param_types)
+    {
+        assert(module);
+        if (auto *const declared = module->getFunction(name)) {
+            return declared;
+        }
+
+        auto *const func = llvm::Function::Create(
+                llvm::FunctionType::get(ret_type, param_types, false),
+                llvm::Function::ExternalLinkage,
+                name,
+                module
+            );
+        func->addFnAttr(llvm::Attribute::NoUnwind);
+        return func;
+    }
+
+    // void *__dachs_array_alloc__(uint64_t elem_size, uint64_t n)
+    llvm::Function *emit_array_alloc_func()
+    {
+        auto *const int_ty = llvm::Type::getInt64Ty(context);
+        return emit_runtime_func("__dachs_array_alloc__", llvm::Type::getInt8PtrTy(context), {int_ty, int_ty});
+    }
+
+    // void *__dachs_array_new__(void *elems, uint64_t size)
+    llvm::Function *emit_array_new_func()
+    {
+        auto *const ptr_ty = llvm::Type::getInt8PtrTy(context);
+        return emit_runtime_func("__dachs_array_new__", ptr_ty, {ptr_ty, llvm::Type::getInt64Ty(context)});
+    }
+
+    // void __dachs_array_grow__(void **array, uint64_t elem_size)
+    llvm::Function *emit_array_grow_func()
+    {
+        return emit_runtime_func(
+                "__dachs_array_grow__",
+                llvm::Type::getVoidTy(context),
+                {llvm::Type::getInt8PtrTy(context)->getPointerTo(), llvm::Type::getInt64Ty(context)}
+            );
+    }
+
+    // void *__dachs_dict_new__(uint64_t entry_size, uint64_t key_size, uint64_t value_offset, uint64_t key_kind)
+    llvm::Function *emit_dict_new_func()
+    {
+        auto *const int_ty = llvm::Type::getInt64Ty(context);
+        return emit_runtime_func("__dachs_dict_new__", llvm::Type::getInt8PtrTy(context), {int_ty, int_ty, int_ty, int_ty});
+    }
+
+    // void *__dachs_dict_insert__(void *dict, void const* key)
+    llvm::Function *emit_dict_insert_func()
+    {
+        auto *const ptr_ty = llvm::Type::getInt8PtrTy(context);
+        return emit_runtime_func("__dachs_dict_insert__", ptr_ty, {ptr_ty, ptr_ty});
+    }
+
+    // void *__dachs_dict_at__(void *dict, void const* key)
+    llvm::Function *emit_dict_at_func()
+    {
+        auto *const ptr_ty = llvm::Type::getInt8PtrTy(context);
+        return emit_runtime_func("__dachs_dict_at__", ptr_ty, {ptr_ty, ptr_ty});
+    }
+
+    // uint64_t __dachs_dict_capacity__(void *dict)
+    llvm::Function *emit_dict_capacity_func()
+    {
+        return emit_runtime_func("__dachs_dict_capacity__", llvm::Type::getInt64Ty(context), {llvm::Type::getInt8PtrTy(context)});
+    }
+
+    // void *__dachs_dict_entry_at__(void *dict, uint64_t idx)
+    llvm::Function *emit_dict_entry_at_func()
+    {
+        auto *const ptr_ty = llvm::Type::getInt8PtrTy(context);
+        return emit_runtime_func("__dachs_dict_entry_at__", ptr_ty, {ptr_ty, llvm::Type::getInt64Ty(context)});
+    }
+
+    // void __dachs_parallel_for__(void (*body)(void *env, uint64_t begin, uint64_t end), void *env, uint64_t n)
+    llvm::Function *emit_parallel_for_func()
+    {
+        auto *const ptr_ty = llvm::Type::getInt8PtrTy(context);
+        auto *const int_ty = llvm::Type::getInt64Ty(context);
+        return emit_runtime_func("__dachs_parallel_for__", llvm::Type::getVoidTy(context), {emit_parallel_for_body_type()->getPointerTo(), ptr_ty, int_ty});
+    }
+
+    llvm::FunctionType *emit_parallel_for_body_type() const
+    {
+        auto *const int_ty = llvm::Type::getInt64Ty(context);
+        return llvm::FunctionType::get(llvm::Type::getVoidTy(context), {llvm::Type::getInt8PtrTy(context), int_ty, int_ty}, false);
+    }
+
+    // void __dachs_string_concat__(string *result, string const* pieces, uint64_t n)
+    // Note:
+    // The result is returned through the pointer because how a struct is returned
+    // by value depends on the C ABI of the platform.
+    llvm::Function *emit_string_concat_func(llvm::Type *const string_type)
+    {
+        auto *const string_ptr_type = string_type->getPointerTo();
+        return emit_runtime_func(
+                "__dachs_string_concat__",
+                llvm::Type::getVoidTy(context),
+                {string_ptr_type, string_ptr_type, llvm::Type::getInt64Ty(context)}
+            );
+    }
+
+    // void __dachs_string_release__(string *s)
+    llvm::Function *emit_string_release_func(llvm::Type *const string_type)
+    {
+        return emit_runtime_func(
+                "__dachs_string_release__",
+                llvm::Type::getVoidTy(context),
+                {string_type->getPointerTo()}
+            );
+    }
+
+    // int64_t __dachs_string_compare__(char const* lhs, uint64_t lhs_len, char const* rhs, uint64_t rhs_len)
+    llvm::Function *emit_string_compare_func()
+    {
+        return emit_string_query_func("__dachs_string_compare__", llvm::Type::getInt64Ty(context));
+    }
+
+    // bool __dachs_string_equal__(char const* lhs, uint64_t lhs_len, char const* rhs, uint64_t rhs_len)
+    llvm::Function *emit_string_equal_func()
+    {
+        return emit_string_query_func("__dachs_string_equal__", llvm::Type::getInt1Ty(context));
+    }
+
+    // Note:
+    // The functions only read the characters of strings
+    llvm::Function *emit_string_query_func(std::string const& name, llvm::Type *const ret_type)
+    {
+        auto *const ptr_ty = llvm::Type::getInt8PtrTy(context);
+        auto *const int_ty = llvm::Type::getInt64Ty(context);
+        auto *const func = emit_runtime_func(name, ret_type, {ptr_ty, int_ty, ptr_ty, int_ty});
+        func->addFnAttr(llvm::Attribute::ReadOnly);
+        return func;
+    }
+
     // TODO:
     // This is temporary implementation.
     llvm::Function *emit_print_func(type::builtin_type const& arg_type)
@@ -1,6 +1,8 @@
 #if !defined DACHS_CODEGEN_LLVMIR_CONTEXT_HPP_INCLUDED
 #define      DACHS_CODEGEN_LLVMIR_CONTEXT_HPP_INCLUDED
 
+#include <string>
+
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/Support/Host.h>
@@ -9,8 +11,11 @@
 #include <llvm/ADT/Triple.h>
 #include <llvm/IR/DataLayout.h>
 #include <llvm/Target/TargetMachine.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/ADT/StringMap.h>
 
 #include "dachs/exception.hpp"
+#include "dachs/codegen/llvmir/stack_allocator.hpp"
 
 namespace dachs {
 namespace codegen {
@@ -41,6 +46,49 @@ public:
     {}
 };
 
+// Note:
+// CPU name and features (e.g. "+avx2,+fma") given to the target machine.
+// "native" means the host CPU and all features it supports.
+struct target_spec {
+    std::string cpu;
+    std::string features;
+
+    bool is_native() const noexcept
+    {
+        return cpu == "native";
+    }
+
+    std::string cpu_name() const
+    {
+        return is_native() ? llvm::sys::getHostCPUName().str() : cpu;
+    }
+
+    std::string feature_string() const
+    {
+        if (!is_native()) {
+            return features;
+        }
+
+        llvm::StringMap<bool> host_features;
+        if (!llvm::sys::getHostCPUFeatures(host_features)) {
+            return features;
+        }
+
+        llvm::SubtargetFeatures result;
+        for (auto const& f : host_features) {
+            result.AddFeature(f.getKey(), f.getValue());
+        }
+
+        // Note:
+        // Features specified explicitly override the host's ones
+        if (!features.empty()) {
+            result.AddFeature(features);
+        }
+
+        return result.getString();
+    }
+};
+
 class context final : private context_base {
 
     std::string tmp_buffer;
@@ -54,6 +102,7 @@ public:
     llvm::DataLayout const* const data_layout;
     llvm::LLVMContext &llvm_context;
     llvm::IRBuilder<> builder;
+    stack_allocator allocator;
 
     context(
         llvm::Triple const triple,
@@ -71,18 +120,20 @@ public:
         , data_layout(data_layout)
         , llvm_context(llvm_context)
         , builder(llvm_context)
+        , allocator(builder, data_layout)
     {}
 
-    context()
+    explicit context(target_spec const& spec = {})
         : context_base()
         , tmp_buffer()
         , triple(llvm::sys::getDefaultTargetTriple())
         , target(llvm::TargetRegistry::lookupTarget(triple.getTriple(), tmp_buffer))
         , options()
-        , target_machine(target->createTargetMachine(triple.getTriple(), ""/*cpu name*/, ""/*feature*/, options))
+        , target_machine(target->createTargetMachine(triple.getTriple(), spec.cpu_name(), spec.feature_string(), options))
         , data_layout(target_machine->getDataLayout())
         , llvm_context(llvm::getGlobalContext())
         , builder(llvm_context)
+        , allocator(builder, data_layout)
     {
         if (!target) {
             throw code_generation_error{"LLVM IR generator", boost::format("On looking up target with '%1%': %2%") % triple.getTriple() % tmp_buffer};
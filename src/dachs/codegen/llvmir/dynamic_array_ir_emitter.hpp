@@ -0,0 +1,149 @@
+#if !defined DACHS_CODEGEN_LLVMIR_DYNAMIC_ARRAY_IR_EMITTER_HPP_INCLUDED
+#define      DACHS_CODEGEN_LLVMIR_DYNAMIC_ARRAY_IR_EMITTER_HPP_INCLUDED
+
+#include <cassert>
+
+#include <llvm/IR/Value.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/DerivedTypes.h>
+
+#include "dachs/codegen/llvmir/context.hpp"
+#include "dachs/codegen/llvmir/builtin_func_ir_emitter.hpp"
+
+namespace dachs {
+namespace codegen {
+namespace llvmir {
+
+// Note:
+// A dynamically sized array is a handle (i8*) of the header { i8*, size, capacity } which
+// points to its elements (see runtime/array.cpp).  Like a dictionary, copies of an array
+// share the header.  So the elements reallocated by push() are visible from all copies.
+// A zero-initialized handle (null) is an empty array.
+class dynamic_array_ir_emitter {
+    context &ctx;
+    builtin_function_emitter builtin_func_emitter;
+
+    using val = llvm::Value *;
+
+public:
+
+    static llvm::StructType *get_header_type(llvm::LLVMContext &c)
+    {
+        auto *const int_ty = llvm::Type::getInt64Ty(c);
+        return llvm::StructType::get(c, {llvm::Type::getInt8PtrTy(c), int_ty, int_ty});
+    }
+
+    explicit dynamic_array_ir_emitter(context &c)
+        : ctx(c), builtin_func_emitter(c.llvm_context)
+    {
+        assert(ctx.builder.GetInsertBlock());
+        builtin_func_emitter.set_module(get_module());
+    }
+
+    // Note:
+    // An array variable is a pointer to the handle
+    val emit_handle(val const a)
+    {
+        return a->getType()->getPointerElementType()->isPointerTy() ? ctx.builder.CreateLoad(a, "array.handle") : a;
+    }
+
+    val emit_size(val const a)
+    {
+        return ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(emit_header(a), 1u), "array.size");
+    }
+
+    val emit_capacity(val const a)
+    {
+        return ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(emit_header(a), 2u), "array.capacity");
+    }
+
+    val emit_elems(val const a, llvm::Type *const elem_ty)
+    {
+        return ctx.builder.CreateBitCast(
+                ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(emit_header(a), 0u)),
+                elem_ty->getPointerTo(),
+                "array.elems"
+            );
+    }
+
+    val emit_elem_ptr(val const a, llvm::Type *const elem_ty, val const index)
+    {
+        return ctx.builder.CreateInBoundsGEP(emit_elems(a, elem_ty), index);
+    }
+
+    // Note:
+    // The header of an array which never escapes from the frame is allocated in the stack.
+    // Otherwise the runtime allocates it.
+    val emit_new(val const elems, val const size, bool const on_stack)
+    {
+        auto *const elems_val = ctx.builder.CreateBitCast(elems, ctx.builder.getInt8PtrTy());
+
+        if (!on_stack) {
+            return ctx.builder.CreateCall2(builtin_func_emitter.emit_array_new_func(), elems_val, size, "array.new");
+        }
+
+        auto *const header = ctx.allocator.allocate(get_header_type(ctx.llvm_context), "array.header");
+        ctx.builder.CreateStore(elems_val, ctx.builder.CreateStructGEP(header, 0u));
+        ctx.builder.CreateStore(size, ctx.builder.CreateStructGEP(header, 1u));
+        ctx.builder.CreateStore(size, ctx.builder.CreateStructGEP(header, 2u));
+        return ctx.builder.CreateBitCast(header, ctx.builder.getInt8PtrTy(), "array.new");
+    }
+
+    // Note:
+    // The runtime allocates the header when the handle in the variable is null
+    void emit_grow(val const array_var, llvm::Type *const elem_ty)
+    {
+        assert(array_var->getType()->getPointerElementType()->isPointerTy());
+        ctx.builder.CreateCall2(
+                builtin_func_emitter.emit_array_grow_func(),
+                array_var,
+                ctx.builder.getInt64(ctx.data_layout->getTypeAllocSize(elem_ty))
+            );
+    }
+
+private:
+
+    llvm::Module *get_module() const
+    {
+        return ctx.builder.GetInsertBlock()->getParent()->getParent();
+    }
+
+    // Note:
+    // A null handle refers to the constant header of empty array instead.  So the fields are
+    // loaded without branch.
+    val emit_header(val const a)
+    {
+        auto *const header_ty = get_header_type(ctx.llvm_context);
+        auto *const module = get_module();
+
+        auto *empty = module->getNamedGlobal("__dachs_empty_array__");
+        if (!empty) {
+            empty = new llvm::GlobalVariable(
+                    *module,
+                    header_ty,
+                    true /*constant*/,
+                    llvm::GlobalValue::PrivateLinkage,
+                    llvm::ConstantAggregateZero::get(header_ty),
+                    "__dachs_empty_array__"
+                );
+        }
+
+        auto *const handle = emit_handle(a);
+        return ctx.builder.CreateSelect(
+                ctx.builder.CreateIsNull(handle),
+                empty,
+                ctx.builder.CreateBitCast(handle, header_ty->getPointerTo()),
+                "array.header"
+            );
+    }
+};
+
+} // namespace llvmir
+} // namespace codegen
+} // namespace dachs
+
+#endif    // DACHS_CODEGEN_LLVMIR_DYNAMIC_ARRAY_IR_EMITTER_HPP_INCLUDED
@@ -12,6 +12,8 @@
 #include <llvm/PassManager.h>
 #include <llvm/Support/ToolOutputFile.h>
 #include <llvm/Support/FormattedStream.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
 
 #include "dachs/codegen/llvmir/executable_generator.hpp"
 #include "dachs/exception.hpp"
@@ -35,8 +37,42 @@ class binary_generator final {
         return file_name.substr(0, dot_pos);
     }
 
+    // Note:
+    // Emitted IR keeps variables in stack slots and relies on LLVM to promote them.
+    // Loops are vectorized for the target CPU given by --march, --mcpu and --mattr.
+    // Hints attached to loops as 'llvm.loop' metadata are respected by the vectorizers.
+    void optimize(llvm::Module &module)
+    {
+        llvm::PassManagerBuilder builder;
+        builder.OptLevel = 3u;
+        builder.SizeLevel = 0u;
+        builder.LoopVectorize = true;
+        builder.SLPVectorize = true;
+        builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, builder.SizeLevel);
+        builder.LibraryInfo = new llvm::TargetLibraryInfo(ctx.triple);
+
+        llvm::FunctionPassManager fpm{&module};
+        fpm.add(new llvm::DataLayout(*ctx.data_layout));
+        ctx.target_machine->addAnalysisPasses(fpm);
+        builder.populateFunctionPassManager(fpm);
+
+        fpm.doInitialization();
+        for (auto &f : module) {
+            fpm.run(f);
+        }
+        fpm.doFinalization();
+
+        llvm::PassManager pm;
+        pm.add(new llvm::DataLayout(*ctx.data_layout));
+        ctx.target_machine->addAnalysisPasses(pm);
+        builder.populateModulePassManager(pm);
+        pm.run(module);
+    }
+
     std::string generate_object(llvm::Module &module)
     {
+        optimize(module);
+
         llvm::PassManager pm;
         pm.add(new llvm::TargetLibraryInfo(ctx.triple));
         ctx.target_machine->addAnalysisPasses(pm);
@@ -90,7 +126,7 @@ public:
         auto command
             = os_type == llvm::Triple::Darwin
                 ? "ld -macosx_version_min 10.9.0 \"" + objs_string + "\" -o \"" + executable_name + "\" -lSystem -ldachs -L /usr/lib -L /usr/local/lib -L " DACHS_INSTALL_PREFIX "/lib"
-                : (DACHS_CXX_COMPILER " ") + objs_string + " -o " + executable_name + " -ldachs -L /usr/lib -L /usr/local/lib -L " DACHS_INSTALL_PREFIX "/lib"; // Fallback...
+                : (DACHS_CXX_COMPILER " ") + objs_string + " -o " + executable_name + " -ldachs -lpthread -L /usr/lib -L /usr/local/lib -L " DACHS_INSTALL_PREFIX "/lib"; // Fallback...
 
         for (auto const& lib : libdirs) {
             command += " -L \"" + lib + '"';
@@ -174,16 +174,20 @@ public:
         auto *const type = from->getType();
         // Note:
         // Absorb the difference between value types and reference types
-        return check(
-            ctx.builder.CreateAlloca(
-                llvm::isa<llvm::AllocaInst>(from) || llvm::isa<llvm::GetElementPtrInst>(from) ?
-                    type->getPointerElementType()
-                  : type
-                , array_size
-                , name
-            )
-            , "alloca instruction"
-        );
+        auto *const allocated_type
+            = llvm::isa<llvm::AllocaInst>(from)
+                || llvm::isa<llvm::GetElementPtrInst>(from)
+                || (llvm::isa<llvm::Argument>(from) && is_aggregate_ptr(type)) ?
+                type->getPointerElementType()
+              : type;
+
+        if (array_size) {
+            // Note:
+            // Dynamic sized allocation can't be hoisted to the entry block
+            return check(ctx.builder.CreateAlloca(allocated_type, array_size, name), "alloca instruction");
+        }
+
+        return check(ctx.allocator.allocate(allocated_type, name), "alloca instruction");
     }
 
     template<class String = char const* const>
@@ -217,39 +221,10 @@ public:
                 ctx.data_layout->getTypeAllocSize(aggregate_type),
                 ctx.data_layout->getPrefTypeAlignment(aggregate_type)
             );
-            if (auto *const struct_type = llvm::dyn_cast<llvm::StructType>(aggregate_type)) {
-                for (uint64_t const idx : irange(0u, struct_type->getNumElements())) {
-                    if (!struct_type->getElementType(idx)->isPointerTy()) {
-                        // Note:
-                        // If element type is not pointer, it is already copied by memcpy()
-                        continue;
-                    }
-
-                    auto *const ptr_to_elem = ctx.builder.CreateStructGEP(from, idx);
-                    ctx.builder.CreateStore(
-                            alloc_and_deep_copy(
-                                ctx.builder.CreateLoad(ptr_to_elem)
-                            )
-                            , ptr_to_elem
-                        );
-                }
-
-            } else if (auto *const array_type = llvm::dyn_cast<llvm::ArrayType>(aggregate_type)) {
-                auto *const elem_type = array_type->getArrayElementType();
-
-                if (elem_type->isPointerTy()) {
-                    for (uint64_t const idx : irange(uint64_t{0u}, array_type->getNumElements())) {
-                        auto *const ptr_to_elem = ctx.builder.CreateConstInBoundsGEP2_32(from, 0u, idx);
-                        ctx.builder.CreateStore(
-                                alloc_and_deep_copy(
-                                    ctx.builder.CreateLoad(ptr_to_elem)
-                                ),
-                                ptr_to_elem
-                            );
-                    }
-                }
-
-            } else {
+            // Note:
+            // Pointer elements are shared with the source.  They point to immutable
+            // strings or the elements of dynamically sized arrays, which have reference semantics.
+            if (!aggregate_type->isStructTy() && !aggregate_type->isArrayTy()) {
                 DACHS_RAISE_INTERNAL_COMPILATION_ERROR
             }
 
@@ -1,9 +1,12 @@
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <utility>
 #include <string>
 #include <iostream>
 #include <stack>
+#include <algorithm>
+#include <limits>
 #include <cstdint>
 #include <cassert>
 
@@ -14,6 +17,7 @@
 #include <boost/optional.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/algorithm/cxx11/all_of.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/range/irange.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
@@ -23,6 +27,7 @@
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/Analysis/Verifier.h>
 
 #include "dachs/codegen/llvmir/ir_emitter.hpp"
@@ -33,13 +38,19 @@
 #include "dachs/codegen/llvmir/ir_builder_helper.hpp"
 #include "dachs/codegen/llvmir/tmp_member_ir_emitter.hpp"
 #include "dachs/codegen/llvmir/tmp_constructor_ir_emitter.hpp"
+#include "dachs/codegen/llvmir/tail_call_optimizer.hpp"
+#include "dachs/codegen/llvmir/block_inliner.hpp"
+#include "dachs/codegen/llvmir/string_ir_emitter.hpp"
+#include "dachs/codegen/llvmir/dynamic_array_ir_emitter.hpp"
 #include "dachs/ast/ast.hpp"
+#include "dachs/ast/ast_walker.hpp"
 #include "dachs/semantics/symbol.hpp"
 #include "dachs/semantics/scope.hpp"
 #include "dachs/semantics/type.hpp"
 #include "dachs/semantics/semantics_context.hpp"
 #include "dachs/exception.hpp"
 #include "dachs/fatal.hpp"
+#include "dachs/statistics.hpp"
 #include "dachs/helper/variant.hpp"
 #include "dachs/helper/colorizer.hpp"
 #include "dachs/helper/each.hpp"
@@ -52,9 +63,135 @@ namespace detail {
 
 using helper::variant::apply_lambda;
 using helper::variant::get_as;
+using helper::variant::has;
 using boost::adaptors::transformed;
 using boost::algorithm::all_of;
 
+// Note:
+// push() may reallocate elements of dynamically sized array.  A function which may have side
+// effects may also push to arrays shared with the caller.
+class elems_reallocation_finder {
+    semantics::func_effects_type const& effects;
+
+    template<class Scope>
+    void check(Scope const& callee_scope)
+    {
+        if (callee_scope.expired()) {
+            found = true;
+            return;
+        }
+
+        auto const callee = callee_scope.lock();
+        if (callee->is_builtin) {
+            found = found || callee->name == "push";
+            return;
+        }
+
+        auto const effect = effects.find(callee);
+        found = found || effect == std::end(effects) || effect->second == semantics::func_effect::write;
+    }
+
+public:
+
+    bool found = false;
+
+    explicit elems_reallocation_finder(semantics::func_effects_type const& e) noexcept
+        : effects(e)
+    {}
+
+    template<class Walker>
+    void visit(ast::node::func_invocation const& invocation, Walker const& w)
+    {
+        check(invocation->callee_scope);
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::ufcs_invocation const& ufcs, Walker const& w)
+    {
+        // Note:
+        // When callee_scope is expired, the invocation is an access to a data member.
+        if (!ufcs->callee_scope.expired()) {
+            check(ufcs->callee_scope);
+        }
+        w();
+    }
+
+    template<class Node, class Walker>
+    void visit(Node const&, Walker const& w)
+    {
+        if (!found) {
+            w();
+        }
+    }
+};
+
+// Note:
+// Collect variables which are referred in the body of parallel for.  Captures of lambdas
+// in the body are also referred because the lambda objects are constructed in the body.
+class referred_vars_collector {
+    std::unordered_map<type::generic_func_type, ast::node::tuple_literal> const& lambda_instantiation_map;
+    std::unordered_set<symbol::var_symbol> found;
+
+    void collect_captures(ast::node::lambda_expr const& lambda)
+    {
+        auto const g = type::get<type::generic_func_type>(lambda->type);
+        if (!g) {
+            return;
+        }
+
+        auto const captures = lambda_instantiation_map.find(*g);
+        if (captures != std::end(lambda_instantiation_map)) {
+            auto captured = captures->second;
+            ast::walk_topdown(captured, *this);
+        }
+    }
+
+public:
+
+    // Note: In the order of appearance
+    std::vector<symbol::var_symbol> vars;
+
+    explicit referred_vars_collector(decltype(lambda_instantiation_map) const& m) noexcept
+        : lambda_instantiation_map(m)
+    {}
+
+    template<class Walker>
+    void visit(ast::node::var_ref const& ref, Walker const&)
+    {
+        if (ref->symbol.expired()) {
+            return;
+        }
+
+        auto const sym = ref->symbol.lock();
+        if (found.insert(sym).second) {
+            vars.push_back(sym);
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::lambda_expr const& lambda, Walker const& w)
+    {
+        collect_captures(lambda);
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::ufcs_invocation const& ufcs, Walker const& w)
+    {
+        if (ufcs->do_block_object) {
+            collect_captures(*ufcs->do_block_object);
+        }
+        w();
+    }
+
+    template<class Node, class Walker>
+    void visit(Node const&, Walker const& w)
+    {
+        w();
+    }
+};
+
 class llvm_ir_emitter {
     using val = llvm::Value *;
     using self = llvm_ir_emitter;
@@ -67,9 +204,14 @@ class llvm_ir_emitter {
     builtin_function_emitter builtin_func_emitter;
     std::string const& file;
     std::stack<llvm::BasicBlock *> loop_stack; // Loop stack for continue and break statements
+    llvm::Value *result_slot = nullptr; // sret argument of the function being emitted
+    std::unordered_map<llvm::ConstantArray *, llvm::GlobalVariable *> constant_array_storages;
+    std::unordered_map<std::string, std::pair<std::uint64_t, llvm::Constant *>> interned_symbols;
+    llvm::Constant *null_symbol = nullptr;
     type_ir_emitter type_emitter;
     tmp_member_ir_emitter member_emitter;
     tmp_constructor_ir_emitter ctor_emitter;
+    block_inliner inliner;
 
     auto push_loop(llvm::BasicBlock *loop_value)
     {
@@ -172,6 +314,245 @@ class llvm_ir_emitter {
         }
     }
 
+    // Note:
+    // Immutable tuple and fixed-size array parameters are passed as pointers to the caller's
+    // value instead of first-class aggregates.  Only 'var' parameters are copied in the callee.
+    // Dynamically sized array is already a handle.
+    bool is_passed_by_ref(symbol::var_symbol const& param) const noexcept
+    {
+        if (!param->immutable || param->type.is_unit()) {
+            return false;
+        }
+
+        if (auto const array = type::get<type::array_type>(param->type)) {
+            return static_cast<bool>((*array)->size);
+        }
+
+        return type::is_a<type::tuple_type>(param->type);
+    }
+
+    bool is_address(val const v) const
+    {
+        return llvm::isa<llvm::AllocaInst>(v) || llvm::isa<llvm::GetElementPtrInst>(v) || is_aggregate_ref(v);
+    }
+
+    val get_address(val const v)
+    {
+        if (is_address(v)) {
+            return v;
+        }
+
+        // Note:
+        // Spill the temporary value (e.g. a constant or a returned value) to pass it by pointer
+        auto *const allocated = ctx.allocator.allocate(v->getType());
+        ctx.builder.CreateStore(v, allocated);
+        return allocated;
+    }
+
+    // Note:
+    // Tuples and arrays larger than 2 words are returned through the result slot which
+    // the caller provides as the first argument (sret) to avoid copying the returned value.
+    // Smaller ones are returned as first-class aggregates to keep readnone/readonly functions.
+    bool returns_via_sret(boost::optional<type::type> const& ret_type)
+    {
+        if (!ret_type || ret_type->is_unit()) {
+            return false;
+        }
+
+        if (!type::is_a<type::tuple_type>(*ret_type) && !type::is_a<type::array_type>(*ret_type)) {
+            return false;
+        }
+
+        auto *const t = type_emitter.emit(*ret_type);
+        return ctx.data_layout->getTypeAllocSize(t) > 2u * ctx.data_layout->getPointerSize();
+    }
+
+    template<class Node, class Scope>
+    val create_call(Node const& n, llvm::Value *const callee_ir, Scope const& callee, std::vector<val> const& arg_values, char const* const feature)
+    {
+        auto args = lower_args(callee, arg_values);
+
+        if (!returns_via_sret(callee->ret_type)) {
+            return check(n, ctx.builder.CreateCall(callee_ir, args), feature);
+        }
+
+        auto *const slot = ctx.allocator.allocate(type_emitter.emit(*callee->ret_type));
+        args.insert(std::begin(args), slot);
+        check(n, ctx.builder.CreateCall(callee_ir, args), feature);
+        return slot;
+    }
+
+    // Note:
+    // The value of a literal, a construction or an invocation is a temporary which no variable
+    // refers to.  A variable initialized by it can take over its stack slot.
+    bool is_temporary(ast::node::any_expr const& e) const
+    {
+        return has<ast::node::tuple_literal>(e)
+            || has<ast::node::array_literal>(e)
+            || has<ast::node::object_construct>(e)
+            || has<ast::node::func_invocation>(e)
+            || has<ast::node::ufcs_invocation>(e);
+    }
+
+    // Note:
+    // Elements of dynamically sized array are not in the array object.  The object
+    // is a handle of the header which has a pointer to them (see dynamic_array_ir_emitter).
+    val emit_dynamic_array_elems(val const array_val, type::array_type const& t)
+    {
+        return dynamic_array_ir_emitter{ctx}.emit_elems(array_val, type_emitter.emit(t->element_type));
+    }
+
+    val emit_dynamic_array_elem_ptr(val const array_val, val const index_val, type::array_type const& t)
+    {
+        return ctx.builder.CreateInBoundsGEP(emit_dynamic_array_elems(array_val, t), index_val);
+    }
+
+    // Note:
+    // push(a, e) appends e to the dynamically sized array a.  The capacity is grown by
+    // the runtime only when it is exhausted.  The header is updated in place, so all
+    // copies of 'a' see the pushed element.
+    template<class Node>
+    val emit_array_push(Node const& n, val const array_val, val const elem_val, type::array_type const& t)
+    {
+        auto helper = get_ir_helper(n);
+
+        if (!array_val->getType()->isPointerTy() || !array_val->getType()->getPointerElementType()->isPointerTy()) {
+            error(n, "push() requires an array which is stored in a variable");
+        }
+
+        dynamic_array_ir_emitter array_emitter{ctx};
+        auto *const elem_type = type_emitter.emit(t->element_type);
+
+        auto *const size_val = array_emitter.emit_size(array_val);
+        auto *const capacity_val = array_emitter.emit_capacity(array_val);
+
+        auto *const grow_block = helper.create_block_for_parent("push.grow");
+        auto *const store_block = helper.create_block_for_parent("push.store");
+
+        helper.create_cond_br(ctx.builder.CreateICmpEQ(size_val, capacity_val), grow_block, store_block);
+
+        array_emitter.emit_grow(array_val, elem_type);
+        helper.create_br(store_block);
+
+        // Note:
+        // The handle is reloaded because the runtime allocates the header of a null handle
+        auto *const handle_val = array_emitter.emit_handle(array_val);
+        ctx.builder.CreateStore(get_operand(elem_val), ctx.builder.CreateInBoundsGEP(array_emitter.emit_elems(handle_val, elem_type), size_val));
+        ctx.builder.CreateStore(
+                ctx.builder.CreateNUWAdd(size_val, ctx.builder.getInt64(1u)),
+                ctx.builder.CreateStructGEP(
+                    ctx.builder.CreateBitCast(handle_val, dynamic_array_ir_emitter::get_header_type(ctx.llvm_context)->getPointerTo()),
+                    1u
+                )
+            );
+
+        return llvm::ConstantStruct::getAnon(ctx.llvm_context, {});
+    }
+
+    // Note:
+    // Look up the slot of the value for the key in the hash table.  When 'insert' is true,
+    // a zero-cleared value is inserted if the key is not found.  Otherwise the runtime
+    // aborts the program.
+    val emit_dict_value_ptr(val const dict_val, val const key_val, type::dict_type const& t, bool const insert)
+    {
+        auto *const key = get_operand(key_val);
+        auto *const key_slot = ctx.allocator.allocate(key->getType());
+        ctx.builder.CreateStore(key, key_slot);
+
+        auto *const value_ptr
+            = ctx.builder.CreateCall2(
+                insert ?
+                    builtin_func_emitter.emit_dict_insert_func() :
+                    builtin_func_emitter.emit_dict_at_func(),
+                get_operand(dict_val),
+                ctx.builder.CreateBitCast(key_slot, ctx.builder.getInt8PtrTy())
+            );
+
+        return ctx.builder.CreateBitCast(value_ptr, type_emitter.emit(t->value_type)->getPointerTo());
+    }
+
+    // Note:
+    // Constant arrays iterated by for statements share one private global variable.
+    llvm::GlobalVariable *get_constant_array_storage(llvm::ConstantArray *const a)
+    {
+        auto const itr = constant_array_storages.find(a);
+        if (itr != std::end(constant_array_storages)) {
+            return itr->second;
+        }
+
+        auto *const storage = new llvm::GlobalVariable(*module, a->getType(), true, llvm::GlobalVariable::PrivateLinkage, a);
+        storage->setUnnamedAddr(true);
+        constant_array_storages.emplace(a, storage);
+        return storage;
+    }
+
+    // Note:
+    // Symbols are interned in the module.  A symbol value is a pointer to its name and
+    // the integer id of the symbol is stored just before the name: { i64 id, [N x i8] name }.
+    // Ids are dense and unique in the module, so switch statements can dispatch symbols
+    // with a jump table.  Id 0 is reserved for zero-initialized symbol values.
+    llvm::Constant *create_symbol_storage(std::string const& name, std::uint64_t const id)
+    {
+        auto *const init = llvm::ConstantStruct::getAnon(
+                ctx.llvm_context,
+                {
+                    ctx.builder.getInt64(id),
+                    llvm::ConstantDataArray::getString(ctx.llvm_context, name)
+                }
+            );
+        auto *const storage = new llvm::GlobalVariable(*module, init->getType(), true, llvm::GlobalVariable::PrivateLinkage, init, "symbol." + name);
+        storage->setUnnamedAddr(true);
+
+        llvm::Constant *const indices[] = {ctx.builder.getInt32(0u), ctx.builder.getInt32(1u), ctx.builder.getInt32(0u)};
+        return llvm::ConstantExpr::getInBoundsGetElementPtr(storage, indices);
+    }
+
+    std::pair<std::uint64_t, llvm::Constant *> const& intern_symbol(std::string const& name)
+    {
+        auto const itr = interned_symbols.find(name);
+        if (itr != std::end(interned_symbols)) {
+            return itr->second;
+        }
+
+        auto const id = interned_symbols.size() + 1u;
+        return interned_symbols.emplace(name, std::make_pair(id, create_symbol_storage(name, id))).first->second;
+    }
+
+    val emit_symbol_id(val const symbol_val)
+    {
+        if (!null_symbol) {
+            null_symbol = create_symbol_storage("", 0u);
+        }
+
+        auto *const symbol_ptr = ctx.builder.CreateSelect(ctx.builder.CreateIsNull(symbol_val), null_symbol, symbol_val);
+        auto *const id_ptr
+            = ctx.builder.CreateBitCast(
+                ctx.builder.CreateInBoundsGEP(symbol_ptr, llvm::ConstantInt::getSigned(ctx.builder.getInt64Ty(), -8)),
+                ctx.builder.getInt64Ty()->getPointerTo()
+            );
+        return ctx.builder.CreateLoad(id_ptr, "symbol.id");
+    }
+
+    template<class Scope>
+    std::vector<val> lower_args(Scope const& callee, std::vector<val> const& arg_values)
+    {
+        std::vector<val> args;
+        args.reserve(arg_values.size());
+
+        auto const& params = callee->params;
+        bool const by_ref_available = !callee->is_builtin && params.size() == arg_values.size();
+
+        for (auto const idx : helper::indices(arg_values.size())) {
+            args.push_back(
+                    by_ref_available && is_passed_by_ref(params[idx]) ?
+                        get_address(arg_values[idx]) :
+                        get_operand(arg_values[idx])
+                );
+        }
+
+        return args;
+    }
+
     void emit_func_prototype(ast::node::function_definition const& func_def)
     {
         assert(!func_def->scope.expired());
@@ -179,14 +560,27 @@ class llvm_ir_emitter {
         param_type_irs.reserve(func_def->params.size());
         auto const scope = func_def->scope.lock();
 
+        if (scope->name == "main" && !scope->params.empty()) {
+            // TODO:
+            // Convert argc and argv to [string]
+            throw not_implemented_error{func_def, __FILE__, __func__, __LINE__, "main function with command line arguments"};
+        }
+
+        bool const uses_sret = returns_via_sret(func_def->ret_type);
+        if (uses_sret) {
+            param_type_irs.push_back(type_emitter.emit(*func_def->ret_type)->getPointerTo());
+        }
+
         for (auto const& param_sym : scope->params) {
             auto *const t = type_emitter.emit(param_sym->type);
             assert(t);
-            param_type_irs.push_back(t);
+            param_type_irs.push_back(is_passed_by_ref(param_sym) ? t->getPointerTo() : t);
         }
 
         auto *const func_type_ir = llvm::FunctionType::get(
-                type_emitter.emit(*func_def->ret_type),
+                uses_sret ?
+                    llvm::Type::getVoidTy(ctx.llvm_context) :
+                    type_emitter.emit(*func_def->ret_type),
                 param_type_irs,
                 false // Non-variadic
             );
@@ -206,16 +600,82 @@ class llvm_ir_emitter {
 
         check(func_def, func_type_ir, "function");
 
+        // Note:
+        // Dachs has no exception.  Effects inferred in semantic analysis let LLVM
+        // eliminate or hoist redundant invocations.
+        func_ir->addFnAttr(llvm::Attribute::NoUnwind);
+
+        // Note:
+        // A function returning via sret writes to caller's memory.  It can't be readnone nor readonly.
+        // A function taking a parameter by pointer reads caller's memory.  It can't be readnone.
+        if (scope->name != "main" && !uses_sret) {
+            auto const effect = semantics_ctx.func_effects.find(scope);
+            if (effect != std::end(semantics_ctx.func_effects)) {
+                bool const reads_ref_param
+                    = std::any_of(
+                        std::begin(scope->params),
+                        std::end(scope->params),
+                        [this](auto const& p){ return is_passed_by_ref(p); }
+                    );
+
+                if (effect->second == semantics::func_effect::none && !reads_ref_param) {
+                    func_ir->addFnAttr(llvm::Attribute::ReadNone);
+                } else if (effect->second != semantics::func_effect::write) {
+                    func_ir->addFnAttr(llvm::Attribute::ReadOnly);
+                }
+            }
+        }
+
         {
             auto arg_itr = func_ir->arg_begin();
+            unsigned idx = 1u;
+
+            if (uses_sret) {
+                arg_itr->setName("result");
+                func_ir->addAttribute(idx, llvm::Attribute::StructRet);
+                func_ir->addAttribute(idx, llvm::Attribute::NoAlias);
+                ++arg_itr;
+                ++idx;
+            }
+
             auto param_itr = std::begin(scope->params);
-            for (; param_itr != std::end(scope->params); ++arg_itr, ++param_itr) {
+            for (; param_itr != std::end(scope->params); ++arg_itr, ++param_itr, ++idx) {
                 arg_itr->setName((*param_itr)->name);
                 var_table.insert(*param_itr, arg_itr);
+
+                if (is_passed_by_ref(*param_itr)) {
+                    // Note:
+                    // Immutable parameter can't be modified and can't escape from the callee
+                    // because it is copied when it is stored to other variables.
+                    func_ir->addAttribute(idx, llvm::Attribute::ReadOnly);
+                    func_ir->addAttribute(idx, llvm::Attribute::NoAlias);
+                    func_ir->addAttribute(idx, llvm::Attribute::NoCapture);
+                }
             }
         }
 
         func_table.emplace(scope, func_ir);
+
+        if (scope->is_anonymous()) {
+            inliner.add_block(func_ir);
+        } else if (receives_block(scope)) {
+            inliner.add_block_receiver(func_ir);
+        }
+    }
+
+    bool receives_block(scope::func_scope const& scope) const
+    {
+        return boost::algorithm::any_of(
+                scope->params,
+                [](auto const& param)
+                {
+                    auto const g = type::get<type::generic_func_type>(param->type);
+                    return g
+                        && (*g)->ref
+                        && !(*g)->ref->expired()
+                        && (*g)->ref->lock()->is_anonymous();
+                }
+            );
     }
 
     bool is_available_type_for_binary_expression(type::type const& lhs, type::type const& rhs) const noexcept
@@ -233,7 +693,7 @@ class llvm_ir_emitter {
 
         auto const lhs_builtin_type = *type::get<type::builtin_type>(lhs);
         auto const rhs_builtin_type = *type::get<type::builtin_type>(rhs);
-        auto const is_supported = [](auto const& t){ return t->name == "int" || t->name == "float" || t->name == "uint" || t->name == "bool" || t->name == "char"; };
+        auto const is_supported = [](auto const& t){ return t->name == "int" || t->name == "float" || t->name == "uint" || t->name == "bool" || t->name == "char" || t->name == "string" || type::get_simd_vector_info(t); };
 
         return is_supported(lhs_builtin_type) && is_supported(rhs_builtin_type);
     }
@@ -270,8 +730,11 @@ class llvm_ir_emitter {
                     emitter.error(access, "Index is not a constant.");
                 }
                 return emitter.ctx.builder.CreateStructGEP(child_val, constant_index->getZExtValue());
-            } else if (type::is_a<type::array_type>(child_type)) {
+            } else if (auto const maybe_array_type = type::get<type::array_type>(child_type)) {
                 assert(!index_val->getType()->isPointerTy());
+                if (!(*maybe_array_type)->size) {
+                    return emitter.emit_dynamic_array_elem_ptr(child_val, index_val, *maybe_array_type);
+                }
                 return emitter.ctx.builder.CreateInBoundsGEP(
                         child_val,
                         (val [2]){
@@ -279,6 +742,11 @@ class llvm_ir_emitter {
                             index_val
                         }
                     );
+            } else if (auto const maybe_dict_type = type::get<type::dict_type>(child_type)) {
+                return emitter.emit_dict_value_ptr(child_val, index_val, *maybe_dict_type, true);
+            } else if (type::get_simd_vector_info(child_type)) {
+                assert(child_val->getType()->isPointerTy());
+                return emitter.emit_lane_ptr(child_val, index_val);
             } else {
                 emitter.error(access, "Not a tuple value (in assignment statement)");
             }
@@ -312,7 +780,8 @@ public:
         , file(f)
         , type_emitter(ctx.llvm_context, sc.lambda_captures)
         , member_emitter(ctx)
-        , ctor_emitter(ctx, type_emitter)
+        , ctor_emitter(ctx, type_emitter, builtin_func_emitter)
+        , inliner(ctx.data_layout)
     {}
 
     // Note:
@@ -325,13 +794,21 @@ public:
     {
         // XXX:
         // This condition is too ad hoc.
-        if (llvm::isa<llvm::AllocaInst>(value) || llvm::isa<llvm::GetElementPtrInst>(value)) {
+        if (llvm::isa<llvm::AllocaInst>(value) || llvm::isa<llvm::GetElementPtrInst>(value) || is_aggregate_ref(value)) {
             return ctx.builder.CreateLoad(value);
         } else {
             return value;
         }
     }
 
+    // Note:
+    // An aggregate parameter passed by pointer (see is_passed_by_ref())
+    template<class T>
+    bool is_aggregate_ref(T *const value) const
+    {
+        return llvm::isa<llvm::Argument>(value) && detail::is_aggregate_ptr(value->getType());
+    }
+
     val emit(ast::node::primary_literal const& pl)
     {
         struct literal_visitor : public boost::static_visitor<val> {
@@ -363,7 +840,7 @@ public:
 
             val operator()(std::string const& s)
             {
-                return c.builder.CreateGlobalStringPtr(s.c_str());
+                return string_ir_emitter{c}.emit_constant(s);
             }
 
             val operator()(int const i)
@@ -387,6 +864,11 @@ public:
         return check(pl, boost::apply_visitor(visitor, pl->value), "constant");
     }
 
+    val emit(ast::node::symbol_literal const& sym)
+    {
+        return intern_symbol(sym->value).second;
+    }
+
     template<class Expr>
     val emit_tuple_constant(type::tuple_type const& t, std::vector<Expr> const& elem_exprs)
     {
@@ -406,7 +888,7 @@ public:
 
             return llvm::ConstantStruct::getAnon(ctx.llvm_context, elem_consts);
         } else {
-            auto *const alloca_inst = ctx.builder.CreateAlloca(type_emitter.emit(t));
+            auto *const alloca_inst = ctx.allocator.allocate(type_emitter.emit(t));
             for (auto const idx : helper::indices(elem_values.size())) {
                 auto *const elem_val = get_operand(elem_values[idx]);
                 ctx.builder.CreateStore(
@@ -452,10 +934,10 @@ public:
 
             return llvm::ConstantArray::get(type_emitter.emit_fixed_array(t), elem_consts);
         } else {
-            auto *const alloca_inst = ctx.builder.CreateAlloca(type_emitter.emit(t));
-            for (auto const idx : helper::indices(elem_exprs.size())) {
+            auto *const alloca_inst = ctx.allocator.allocate(type_emitter.emit(t));
+            for (auto const idx : helper::indices(elem_values.size())) {
                 ctx.builder.CreateStore(
-                        get_operand(emit(elem_exprs[idx])),
+                        get_operand(elem_values[idx]),
                         // Note:
                         // CreateStructGEP is also available for array value because
                         // it is equivalent to CreateConstInBoundsGEP2_32(v, 0u, i).
@@ -493,6 +975,21 @@ public:
             );
     }
 
+    val emit(ast::node::dict_literal const& dict)
+    {
+        auto const dict_type = type::get<type::dict_type>(dict->type);
+        assert(dict_type);
+
+        auto *const dict_val = check(dict, ctor_emitter.emit_empty_dict(*dict_type), "dictionary literal");
+        for (auto const& elem : dict->value) {
+            auto *const key_val = emit(elem.first);
+            auto *const value_val = get_operand(emit(elem.second));
+            ctx.builder.CreateStore(value_val, emit_dict_value_ptr(dict_val, key_val, *dict_type, true));
+        }
+
+        return dict_val;
+    }
+
     val emit(ast::node::lambda_expr const& lambda)
     {
         auto const g = type::get<type::generic_func_type>(lambda->type);
@@ -548,6 +1045,8 @@ public:
 
         assert(loop_stack.empty());
 
+        inliner.run();
+
         return module;
     }
 
@@ -602,6 +1101,8 @@ public:
         auto &prototype_ir = *maybe_prototype_ir;
         auto const block = llvm::BasicBlock::Create(ctx.llvm_context, "entry", prototype_ir);
         ctx.builder.SetInsertPoint(block);
+        ctx.allocator.enter_function(prototype_ir);
+        result_slot = returns_via_sret(func_def->ret_type) ? &*prototype_ir->arg_begin() : nullptr;
 
         for (auto const& p : func_def->params) {
             emit(p);
@@ -609,29 +1110,34 @@ public:
 
         emit(func_def->body);
 
-        if (ctx.builder.GetInsertBlock()->getTerminator()) {
-            return;
-        }
+        result_slot = nullptr;
 
-        if (!func_def->ret_type
-                || func_def->kind == ast::symbol::func_kind::proc
-                || *func_def->ret_type == type::get_unit_type()) {
-            ctx.builder.CreateRet(
-                llvm::ConstantStruct::getAnon(ctx.llvm_context, {})
-            );
-        } else {
-            // Note:
-            // Believe that the insert block is the last block of the function
-            ctx.builder.CreateUnreachable();
+        if (!ctx.builder.GetInsertBlock()->getTerminator()) {
+            if (!func_def->ret_type
+                    || func_def->kind == ast::symbol::func_kind::proc
+                    || *func_def->ret_type == type::get_unit_type()) {
+                ctx.builder.CreateRet(
+                    llvm::ConstantStruct::getAnon(ctx.llvm_context, {})
+                );
+            } else {
+                // Note:
+                // Believe that the insert block is the last block of the function
+                ctx.builder.CreateUnreachable();
+            }
         }
+
+        tail_call_optimizer{*prototype_ir}.optimize();
+        ctx.allocator.exit_function();
     }
 
     void emit(ast::node::statement_block const& block)
     {
         // Basic block is already emitd on visiting function_definition and for_stmt
+        ctx.allocator.enter_scope();
         for (auto const& stmt : block->value) {
             emit(stmt);
         }
+        ctx.allocator.exit_scope();
     }
 
     void emit(ast::node::if_stmt const& if_)
@@ -670,6 +1176,40 @@ public:
         helper.append_block(end_block);
     }
 
+    template<class Exprs>
+    void emit_elems_to_slot(Exprs const& elem_exprs, llvm::Value *const slot)
+    {
+        for (auto const idx : helper::indices(elem_exprs.size())) {
+            ctx.builder.CreateStore(
+                    get_operand(emit(elem_exprs[idx])),
+                    // Note:
+                    // CreateStructGEP is also available for array value.
+                    ctx.builder.CreateStructGEP(slot, idx)
+                );
+        }
+    }
+
+    // Note:
+    // Construct the returned value in the caller's result slot directly
+    void emit_return_to_slot(ast::node::return_stmt const& return_)
+    {
+        assert(result_slot);
+
+        if (return_->ret_exprs.size() > 1) {
+            emit_elems_to_slot(return_->ret_exprs, result_slot);
+            return;
+        }
+
+        auto const& ret_expr = return_->ret_exprs[0];
+        if (auto const tuple = get_as<ast::node::tuple_literal>(ret_expr)) {
+            emit_elems_to_slot((*tuple)->element_exprs, result_slot);
+        } else if (auto const array = get_as<ast::node::array_literal>(ret_expr)) {
+            emit_elems_to_slot((*array)->element_exprs, result_slot);
+        } else {
+            get_ir_helper(return_).create_deep_copy(emit(ret_expr), result_slot);
+        }
+    }
+
     void emit(ast::node::return_stmt const& return_)
     {
         if (ctx.builder.GetInsertBlock()->getTerminator()) {
@@ -679,18 +1219,25 @@ public:
             return;
         }
 
-        if (return_->ret_exprs.size() == 1) {
-            ctx.builder.CreateRet(get_operand(emit(return_->ret_exprs[0])));
+        if (result_slot) {
+            emit_return_to_slot(return_);
+            ctx.allocator.end_scopes_for_return();
+            ctx.builder.CreateRetVoid();
+        } else if (return_->ret_exprs.size() == 1) {
+            auto *const ret_val = get_operand(emit(return_->ret_exprs[0]));
+            ctx.allocator.end_scopes_for_return();
+            ctx.builder.CreateRet(ret_val);
         } else {
             assert(type::is_a<type::tuple_type>(return_->ret_type));
-            ctx.builder.CreateRet(
-                get_operand(
+            auto *const ret_val
+                = get_operand(
                     emit_tuple_constant(
                         *type::get<type::tuple_type>(return_->ret_type),
                         return_->ret_exprs
                     )
-                )
-            );
+                );
+            ctx.allocator.end_scopes_for_return();
+            ctx.builder.CreateRet(ret_val);
         }
     }
 
@@ -703,6 +1250,13 @@ public:
             error(n, boost::format("'%1%' is unresolved overloaded function '%2%'") % scope->name % scope->to_string());
         }
 
+        // Note:
+        // Prototypes of all functions are registered to func_table in advance.
+        // Looking up by the scope avoids formatting the signature string on every call.
+        if (auto const func_ir = lookup_func(scope)) {
+            return *func_ir;
+        }
+
         return check(
                 n,
                 module->getFunction(scope->to_string()),
@@ -730,48 +1284,251 @@ public:
         return emit_non_builtin_callee(n, scope);
     }
 
-    val emit(ast::node::func_invocation const& invocation)
+    // Note:
+    // An argument of print() is lowered to pieces.  A piece is a constant text or a value of
+    // builtin type.
+    struct print_piece {
+        std::string text;
+        val value;
+        type::builtin_type type;
+    };
+
+    void add_print_text(std::vector<print_piece> &pieces, std::string const& text) const
     {
-        std::vector<val> args;
-        args.reserve(invocation->args.size());
-        for (auto const& a : invocation->args) {
-            args.push_back(get_operand(emit(a)));
+        if (!pieces.empty() && !pieces.back().value) {
+            pieces.back().text += text;
+        } else {
+            pieces.push_back(print_piece{text, nullptr, nullptr});
         }
+    }
 
-        auto const child_type = type::type_of(invocation->child);
-        auto const generic = type::get<type::generic_func_type>(child_type);
-        if (!generic) {
-            // TODO:
-            // Deal with func_type
-            error(invocation, boost::format("calls '%1%' type variable which is not callable") % child_type.to_string());
+    // Note:
+    // Float literals are not formatted here.  They are printed by the runtime to get the same
+    // digits as float values in variables.
+    boost::optional<std::string> literal_text(ast::node::any_expr const& e) const
+    {
+        if (auto const sym = get_as<ast::node::symbol_literal>(e)) {
+            return (*sym)->value;
+        }
+
+        auto const lit = get_as<ast::node::primary_literal>(e);
+        if (!lit) {
+            return boost::none;
+        }
+
+        struct text_visitor : public boost::static_visitor<boost::optional<std::string>> {
+            result_type operator()(char const c) const
+            {
+                return std::string(1u, c);
+            }
+
+            result_type operator()(double const) const
+            {
+                return boost::none;
+            }
+
+            result_type operator()(bool const b) const
+            {
+                return std::string{b ? "true" : "false"};
+            }
+
+            result_type operator()(std::string const& s) const
+            {
+                return s;
+            }
+
+            result_type operator()(int const i) const
+            {
+                return std::to_string(i);
+            }
+
+            result_type operator()(unsigned int const u) const
+            {
+                return std::to_string(u);
+            }
+        } visitor;
+
+        return boost::apply_visitor(visitor, (*lit)->value);
+    }
+
+    void collect_print_pieces(std::vector<print_piece> &pieces, val const v, type::type const& t)
+    {
+        if (auto const tuple = type::get<type::tuple_type>(t)) {
+            auto const& elem_types = (*tuple)->element_types;
+            add_print_text(pieces, "(");
+            for (auto const idx : helper::indices(elem_types.size())) {
+                if (idx != 0u) {
+                    add_print_text(pieces, ", ");
+                }
+                collect_print_pieces(
+                        pieces,
+                        v->getType()->isPointerTy() ?
+                            ctx.builder.CreateStructGEP(v, idx) :
+                            ctx.builder.CreateExtractValue(v, idx),
+                        elem_types[idx]
+                    );
+            }
+            add_print_text(pieces, ")");
+            return;
+        }
+
+        auto const builtin = type::get<type::builtin_type>(t);
+        assert(builtin);
+        pieces.push_back(print_piece{"", get_operand(v), *builtin});
+    }
+
+    void collect_print_pieces(std::vector<print_piece> &pieces, ast::node::any_expr const& e)
+    {
+        if (auto const text = literal_text(e)) {
+            add_print_text(pieces, *text);
+            return;
         }
 
-        assert(!invocation->callee_scope.expired());
-        assert((*generic)->ref && !(*generic)->ref->expired());
-        auto const callee = invocation->callee_scope.lock();
-
+        // Note:
+        // Operands of concatenation are printed one by one without concatenating them
+        if (auto const bin_expr = get_as<ast::node::binary_expr>(e)) {
+            if (is_string_concat(*bin_expr)) {
+                collect_print_pieces(pieces, (*bin_expr)->lhs);
+                collect_print_pieces(pieces, (*bin_expr)->rhs);
+                return;
+            }
+        }
+
+        if (auto const tuple = get_as<ast::node::tuple_literal>(e)) {
+            auto const& elems = (*tuple)->element_exprs;
+            add_print_text(pieces, "(");
+            for (auto const idx : helper::indices(elems.size())) {
+                if (idx != 0u) {
+                    add_print_text(pieces, ", ");
+                }
+                collect_print_pieces(pieces, elems[idx]);
+            }
+            add_print_text(pieces, ")");
+            return;
+        }
+
+        collect_print_pieces(pieces, emit(e), type::type_of(e));
+    }
+
+    // Note:
+    // print() and println() take any number of values and tuples of them (e.g. 'println("x = ", x)'
+    // prints 'x = 42').  Arguments are written without separator.  Literals are formatted at
+    // compile time and adjacent ones are merged into one string, so a line of literals is
+    // written by one call.  Other values are appended to the output buffer by one runtime call
+    // for each.  Only the last call of println() ends the line, which is the only point where
+    // the runtime may flush.
+    template<class Node, class Exprs>
+    val emit_print(Node const& n, Exprs const& args, bool const ends_line)
+    {
+        std::vector<print_piece> pieces;
+        for (auto const& a : args) {
+            collect_print_pieces(pieces, a);
+        }
+
+        if (ends_line && pieces.empty()) {
+            add_print_text(pieces, "");
+        }
+
+        for (auto const idx : helper::indices(pieces.size())) {
+            auto const& piece = pieces[idx];
+            bool const is_last = ends_line && idx + 1u == pieces.size();
+            if (!piece.value && piece.text.empty() && !is_last) {
+                continue;
+            }
+
+            auto const arg_type = piece.value ? piece.type : type::get_builtin_type("string", type::no_opt);
+            auto *const arg_value = piece.value ? piece.value : string_ir_emitter{ctx}.emit_constant(piece.text);
+
+            std::vector<val> print_args;
+            if (arg_type->name == "string") {
+                // Note: A string is passed as its characters and length
+                string_ir_emitter str_emitter{ctx};
+                print_args = {str_emitter.emit_chars(arg_value), str_emitter.emit_length(arg_value)};
+            } else {
+                print_args = {arg_value};
+            }
+
+            check(
+                    n,
+                    ctx.builder.CreateCall(
+                        is_last ?
+                            builtin_func_emitter.emit_println_func(arg_type) :
+                            builtin_func_emitter.emit_print_func(arg_type),
+                        print_args
+                    ),
+                    "print"
+                );
+        }
+
+        return llvm::ConstantStruct::getAnon(ctx.llvm_context, {});
+    }
+
+    template<class FuncScope>
+    bool is_print_builtin(FuncScope const& callee) const
+    {
+        return callee->is_builtin && (callee->name == "print" || callee->name == "println");
+    }
+
+    val emit(ast::node::func_invocation const& invocation)
+    {
+        if (!invocation->callee_scope.expired() && is_print_builtin(invocation->callee_scope.lock())) {
+            return emit_print(invocation, invocation->args, invocation->callee_scope.lock()->name == "println");
+        }
+
+        std::vector<val> arg_values;
+        arg_values.reserve(invocation->args.size() + 1);
+        for (auto const& a : invocation->args) {
+            arg_values.push_back(emit(a));
+        }
+
+        auto const child_type = type::type_of(invocation->child);
+        auto const generic = type::get<type::generic_func_type>(child_type);
+        if (!generic) {
+            // TODO:
+            // Deal with func_type
+            error(invocation, boost::format("calls '%1%' type variable which is not callable") % child_type.to_string());
+        }
+
+        assert(!invocation->callee_scope.expired());
+        assert((*generic)->ref && !(*generic)->ref->expired());
+        auto const callee = invocation->callee_scope.lock();
+
         // Note:
         // Add a receiver for lambda function invocation
         if (callee->is_anonymous()) {
-            args.insert(std::begin(args), get_operand(emit(invocation->child)));
+            arg_values.insert(std::begin(arg_values), emit(invocation->child));
+        }
+
+        if (callee->is_builtin && callee->name == "push") {
+            assert(arg_values.size() == 2u);
+            auto const array_type = type::get<type::array_type>(type::type_of(invocation->args[0]));
+            assert(array_type);
+            return emit_array_push(invocation, arg_values[0], arg_values[1], *array_type);
+        }
+
+        if (callee->is_builtin && callee->name == "step") {
+            assert(arg_values.size() == 2u);
+            return ctx.builder.CreateInsertValue(get_operand(arg_values[0]), get_operand(arg_values[1]), 2u);
+        }
+
+        if (is_simd_builtin(callee)) {
+            return emit_simd_builtin(invocation, callee->name, arg_values, type::type_of(invocation->args[0]));
         }
 
         if (invocation->do_block) {
-            return check(
+            return create_call(
                         invocation,
-                        ctx.builder.CreateCall(
-                            emit_non_builtin_callee(invocation, callee),
-                            args
-                        ),
+                        emit_non_builtin_callee(invocation, callee),
+                        callee,
+                        arg_values,
                         "invalid function call with do-end block"
                 );
         } else {
-            return check(
+            return create_call(
                         invocation,
-                        ctx.builder.CreateCall(
-                            emit_callee(invocation, callee, invocation->args),
-                            args
-                        ),
+                        emit_callee(invocation, callee, invocation->args),
+                        callee,
+                        arg_values,
                         "invalid function call"
                     );
         }
@@ -787,8 +1544,8 @@ public:
         auto const builtin = *type::get<type::builtin_type>(val_type);
         auto const& name = builtin->name;
 
-        if (name != "int" && name != "float" && name != "bool" && name != "uint") {
-            error(unary, "Unary expression now only supports float, int, bool and uint");
+        if (name != "int" && name != "float" && name != "bool" && name != "uint" && !type::get_simd_vector_info(builtin)) {
+            error(unary, "Unary expression now only supports float, int, bool, uint and SIMD vectors");
         }
 
         return check(
@@ -802,6 +1559,10 @@ public:
 
     val emit(ast::node::binary_expr const& bin_expr)
     {
+        if (type::is_a<type::range_type>(bin_expr->type)) {
+            return emit_range(get_operand(emit(bin_expr->lhs)), get_operand(emit(bin_expr->rhs)));
+        }
+
         auto const lhs_type = type::type_of(bin_expr->lhs);
         auto const rhs_type = type::type_of(bin_expr->rhs);
 
@@ -809,9 +1570,15 @@ public:
             error(bin_expr, "Binary expression now only supports only some builtin types");
         }
 
+        if (is_string_concat(bin_expr)) {
+            std::vector<val> operands;
+            collect_concat_operands(bin_expr, operands);
+            return check(bin_expr, string_ir_emitter{ctx}.emit_concat(operands), "string concatenation");
+        }
+
         return check(
             bin_expr,
-            tmp_builtin_bin_op_ir_emitter{ctx, get_operand(emit(bin_expr->lhs)), get_operand(emit(bin_expr->rhs)), bin_expr->op}.emit(lhs_type),
+            tmp_builtin_bin_op_ir_emitter{ctx, get_operand(emit_owned_string(bin_expr->lhs)), get_operand(emit_owned_string(bin_expr->rhs)), bin_expr->op}.emit(lhs_type),
             boost::format("binary operator '%1%' (lhs type is '%2%', rhs type is '%3%')")
                 % bin_expr->op
                 % type::to_string(lhs_type)
@@ -819,6 +1586,64 @@ public:
         );
     }
 
+    bool is_string_concat(ast::node::binary_expr const& bin_expr) const
+    {
+        return bin_expr->op == "+" && type::type_of(bin_expr->lhs).is_builtin("string");
+    }
+
+    // Note:
+    // Operands of a chain of string concatenations (e.g. 'a + b + c') are concatenated at
+    // once.  The runtime allocates the result only once.
+    void collect_concat_operands(ast::node::any_expr const& e, std::vector<val> &operands)
+    {
+        if (auto const bin_expr = get_as<ast::node::binary_expr>(e)) {
+            if (is_string_concat(*bin_expr)) {
+                collect_concat_operands(*bin_expr, operands);
+                return;
+            }
+        }
+
+        operands.push_back(emit(e));
+    }
+
+    void collect_concat_operands(ast::node::binary_expr const& bin_expr, std::vector<val> &operands)
+    {
+        collect_concat_operands(bin_expr->lhs, operands);
+        collect_concat_operands(bin_expr->rhs, operands);
+    }
+
+    // Note:
+    // The result of concatenation is released by the concatenation itself (see
+    // string_ir_emitter::emit_concat()) when it is consumed at once (e.g. an operand of
+    // comparison) or stored only to a variable which never escapes from the frame.
+    // Such a variable is overwritten right after the concatenation is evaluated again.
+    val emit_owned_string(ast::node::any_expr const& e)
+    {
+        if (auto const bin_expr = get_as<ast::node::binary_expr>(e)) {
+            if (is_string_concat(*bin_expr)) {
+                std::vector<val> operands;
+                collect_concat_operands(*bin_expr, operands);
+                return check(*bin_expr, string_ir_emitter{ctx}.emit_concat(operands, true), "string concatenation");
+            }
+        }
+
+        return emit(e);
+    }
+
+    bool owns_string(symbol::var_symbol const& sym) const
+    {
+        auto const escape = semantics_ctx.escapes.vars.find(sym);
+        return escape != std::end(semantics_ctx.escapes.vars)
+            && escape->second == semantics::escape_kind::none
+            && sym->type.is_builtin("string");
+    }
+
+    bool owns_string(ast::node::any_expr const& e) const
+    {
+        auto const var = get_as<ast::node::var_ref>(e);
+        return var && !(*var)->symbol.expired() && owns_string((*var)->symbol.lock());
+    }
+
     val emit(ast::node::var_ref const& var)
     {
         assert(!var->symbol.expired());
@@ -868,6 +1693,10 @@ public:
         } else if (auto const maybe_array_type = type::get<type::array_type>(child_type)) {
             assert(index_val->getType()->isIntegerTy());
 
+            if (!(*maybe_array_type)->size) {
+                return with_check(emit_dynamic_array_elem_ptr(child_val, index_val, *maybe_array_type));
+            }
+
             if (constant_index && !ty->isPointerTy()) {
                 auto const idx = constant_index->getZExtValue();
                 assert(ty->isArrayTy());
@@ -883,20 +1712,131 @@ public:
                                 child_val :
                                 get_ir_helper(access).alloc_and_deep_copy(child_val),
                             (val [2]){
-                                ctx.builder.getInt32(0u),
-                                index_val->getType()->isIntegerTy(32u) ?
+                                ctx.builder.getInt64(0u),
+                                index_val->getType()->isIntegerTy(64u) ?
                                     index_val :
-                                    ctx.builder.CreateIntCast(index_val, ctx.builder.getInt32Ty(), true)
+                                    ctx.builder.CreateIntCast(index_val, ctx.builder.getInt64Ty(), true)
                             }
                         )
                     );
             }
 
+        } else if (auto const maybe_dict_type = type::get<type::dict_type>(child_type)) {
+            return with_check(ctx.builder.CreateLoad(emit_dict_value_ptr(child_val, index_val, *maybe_dict_type, false)));
+        } else if (type::get_simd_vector_info(child_type)) {
+            return with_check(
+                    ty->isPointerTy() ?
+                        emit_lane_ptr(child_val, index_val) :
+                        ctx.builder.CreateExtractElement(child_val, index_val, "lane")
+                );
+        } else if (child_type.is_builtin("string")) {
+            string_ir_emitter str_emitter{ctx};
+            auto const range = type::get<type::range_type>(type::type_of(access->index_expr));
+            if (!range) {
+                return with_check(str_emitter.emit_char_at(child_val, index_val));
+            }
+
+            // Note:
+            // 's[a..b]' and 's[a...b]' are slices.  Step of the range is not used.
+            auto *const last_val = ctx.builder.CreateExtractValue(index_val, 1u);
+            return with_check(
+                    str_emitter.emit_slice(
+                        child_val,
+                        ctx.builder.CreateExtractValue(index_val, 0u),
+                        (*range)->is_inclusive ?
+                            ctx.builder.CreateAdd(last_val, llvm::ConstantInt::get(last_val->getType(), 1u)) :
+                            last_val
+                    )
+                );
         } else {
-            error(access, "Not a tuple or array value");
+            error(access, "Not a tuple, array, dictionary, SIMD vector or string value");
         }
     }
 
+    // Note:
+    // A SIMD vector in memory is laid out as an array of its elements.  A lane of a vector
+    // variable is accessed through a pointer to the element so that it can be assigned.
+    val emit_lane_ptr(val const vector_ptr, val const index)
+    {
+        auto *const elem_ty = vector_ptr->getType()->getPointerElementType()->getVectorElementType();
+        return ctx.builder.CreateInBoundsGEP(
+                ctx.builder.CreateBitCast(vector_ptr, elem_ty->getPointerTo()),
+                index
+            );
+    }
+
+    template<class FuncScope>
+    bool is_simd_builtin(FuncScope const& callee) const
+    {
+        return callee->is_builtin
+            && (callee->name == "shuffle" || boost::algorithm::starts_with(callee->name, "reduce_"));
+    }
+
+    // Note:
+    // shuffle(v, mask) -> 'shufflevector'.  The mask must be a constant.
+    // reduce_xxx(v)    -> horizontal reduction.  The upper half of lanes is folded into the
+    //                     lower half until one lane remains.  This is the same pattern as
+    //                     the loop vectorizer emits and the backend selects horizontal
+    //                     instructions for it.
+    template<class Node>
+    val emit_simd_builtin(Node const& node, std::string const& name, std::vector<val> const& arg_values, type::type const& vector_type)
+    {
+        auto *vec = get_operand(arg_values[0]);
+        auto const lanes = vec->getType()->getVectorNumElements();
+        auto *const undef = llvm::UndefValue::get(vec->getType());
+
+        if (name == "shuffle") {
+            assert(arg_values.size() == 2u);
+            auto *const mask = llvm::dyn_cast<llvm::Constant>(get_operand(arg_values[1]));
+            if (!mask) {
+                error(node, "Mask of shuffle() must be a constant");
+            }
+
+            std::vector<llvm::Constant *> lane_indices;
+            for (auto const i : helper::indices(lanes)) {
+                auto *const idx = llvm::dyn_cast<llvm::ConstantInt>(mask->getAggregateElement(i));
+                if (!idx || idx->getZExtValue() >= lanes) {
+                    error(node, boost::format("Lane index in mask of shuffle() is out of bounds (lanes:%1%)") % lanes);
+                }
+                lane_indices.push_back(ctx.builder.getInt32(idx->getZExtValue()));
+            }
+
+            return ctx.builder.CreateShuffleVector(vec, undef, llvm::ConstantVector::get(lane_indices), "shuffle");
+        }
+
+        auto const builtin = *type::get<type::builtin_type>(vector_type);
+        auto const fold
+            = [&, this](auto *const lhs, auto *const rhs) -> val
+            {
+                if (name == "reduce_add") {
+                    return tmp_builtin_bin_op_ir_emitter{ctx, lhs, rhs, "+"}.emit(builtin);
+                } else if (name == "reduce_mul") {
+                    return tmp_builtin_bin_op_ir_emitter{ctx, lhs, rhs, "*"}.emit(builtin);
+                } else if (name == "reduce_min" || name == "reduce_max") {
+                    auto *const cmp = tmp_builtin_bin_op_ir_emitter{ctx, lhs, rhs, name == "reduce_min" ? "<" : ">"}.emit(builtin);
+                    return ctx.builder.CreateSelect(cmp, lhs, rhs);
+                } else {
+                    DACHS_RAISE_INTERNAL_COMPILATION_ERROR
+                }
+            };
+
+        for (auto half = lanes / 2u; half > 0u; half /= 2u) {
+            std::vector<llvm::Constant *> upper_half;
+            for (auto const i : helper::indices(lanes)) {
+                upper_half.push_back(
+                        i < half ?
+                            static_cast<llvm::Constant *>(ctx.builder.getInt32(i + half)) :
+                            llvm::UndefValue::get(ctx.builder.getInt32Ty())
+                    );
+            }
+
+            auto *const shuffled = ctx.builder.CreateShuffleVector(vec, undef, llvm::ConstantVector::get(upper_half), "rdx.shuf");
+            vec = check(node, fold(vec, shuffled), name);
+        }
+
+        return ctx.builder.CreateExtractElement(vec, ctx.builder.getInt32(0u), "rdx");
+    }
+
     val emit_data_member(ast::node::ufcs_invocation const& ufcs)
     {
         auto *const child_val = emit(ufcs->child);
@@ -909,7 +1849,9 @@ public:
             auto const func = g->ref->lock();
 
             if (func->is_anonymous()) {
-                auto const& capture = semantics_ctx.lambda_captures.at(func).get<semantics::tags::introduced>().find(ufcs);
+                auto const& captures = semantics_ctx.lambda_captures.at(func);
+                auto const capture = captures.find(ufcs);
+                assert(capture != std::end(captures));
                 return child_val->getType()->isStructTy() ?
                     ctx.builder.CreateExtractValue(child_val, capture->offset) :
                     ctx.builder.CreateStructGEP(child_val, capture->offset);
@@ -942,8 +1884,12 @@ public:
 
         assert(!ufcs->callee_scope.expired());
 
-        std::vector<val> args = {get_operand(emit(ufcs->child))};
         auto const callee = ufcs->callee_scope.lock();
+        if (is_print_builtin(callee)) {
+            return emit_print(ufcs, std::vector<ast::node::any_expr>{{ufcs->child}}, callee->name == "println");
+        }
+
+        std::vector<val> arg_values = {emit(ufcs->child)};
 
         // Note:
         // UFCS invocation never invokes lambda function.
@@ -954,30 +1900,94 @@ public:
             assert(g);
 
             assert(ufcs->do_block_object);
-            args.push_back(get_operand(emit(*ufcs->do_block_object)));
+            arg_values.push_back(emit(*ufcs->do_block_object));
 
             // Note:
             // Add block to the 2nd argument of invocation as function variable
-            return check(
+            return create_call(
                         ufcs,
-                        ctx.builder.CreateCall(
-                            emit_non_builtin_callee(ufcs, callee),
-                            args
-                        ),
+                        emit_non_builtin_callee(ufcs, callee),
+                        callee,
+                        arg_values,
                         "UFCS function invocation with do-end block"
                     );
         }
 
-        return check(
+        if (is_simd_builtin(callee)) {
+            return emit_simd_builtin(ufcs, callee->name, arg_values, type::type_of(ufcs->child));
+        }
+
+        return create_call(
                     ufcs,
-                    ctx.builder.CreateCall(
-                        emit_callee(ufcs, callee, std::vector<ast::node::any_expr>{{ufcs->child}}),
-                        args
-                    ),
+                    emit_callee(ufcs, callee, std::vector<ast::node::any_expr>{{ufcs->child}}),
+                    callee,
+                    arg_values,
                     "UFCS function invocation"
                 );
     }
 
+    // Note:
+    // Loop hints are lowered to 'llvm.loop' metadata attached to all back edges of the loop.
+    //   @vectorize    -> vectorize.enable
+    //   @vectorize(n) -> vectorize.width n (n <= 1 disables vectorization)
+    //   @unroll       -> unroll.enable
+    //   @unroll(n)    -> unroll.count n (n <= 1 disables unrolling)
+    // The first operand of the metadata refers to itself to make the loop ID unique.
+    void emit_loop_metadata(llvm::BasicBlock *const header, llvm::BranchInst *const entry_br, ast::node_type::loop_hints const& hints)
+    {
+        if (hints.empty()) {
+            return;
+        }
+
+        auto const hint_node
+            = [this](char const* const name, llvm::Value *const v = nullptr)
+            {
+                std::vector<llvm::Value *> operands = {llvm::MDString::get(ctx.llvm_context, name)};
+                if (v) {
+                    operands.push_back(v);
+                }
+                return llvm::MDNode::get(ctx.llvm_context, operands);
+            };
+
+        auto *const tmp = llvm::MDNode::getTemporary(ctx.llvm_context, llvm::ArrayRef<llvm::Value *>{});
+        std::vector<llvm::Value *> operands = {tmp};
+
+        for (auto const& hint : hints) {
+            auto const& arg = hint.second;
+            if (hint.first == "vectorize") {
+                if (!arg || *arg > 1u) {
+                    operands.push_back(hint_node("llvm.loop.vectorize.enable", ctx.builder.getTrue()));
+                }
+                if (arg) {
+                    operands.push_back(
+                            *arg > 1u ?
+                                hint_node("llvm.loop.vectorize.width", ctx.builder.getInt32(*arg)) :
+                                hint_node("llvm.loop.vectorize.enable", ctx.builder.getFalse())
+                        );
+                }
+            } else if (hint.first == "unroll") {
+                if (!arg) {
+                    operands.push_back(hint_node("llvm.loop.unroll.enable"));
+                } else if (*arg > 1u) {
+                    operands.push_back(hint_node("llvm.loop.unroll.count", ctx.builder.getInt32(*arg)));
+                } else {
+                    operands.push_back(hint_node("llvm.loop.unroll.disable"));
+                }
+            }
+        }
+
+        auto *const loop_id = llvm::MDNode::get(ctx.llvm_context, operands);
+        loop_id->replaceOperandWith(0u, loop_id);
+        llvm::MDNode::deleteTemporary(tmp);
+
+        for (auto itr = header->use_begin(); itr != header->use_end(); ++itr) {
+            auto *const br = llvm::dyn_cast<llvm::BranchInst>(*itr);
+            if (br && br != entry_br) {
+                br->setMetadata("llvm.loop", loop_id);
+            }
+        }
+    }
+
     void emit(ast::node::while_stmt const& while_)
     {
         auto helper = get_ir_helper(while_);
@@ -987,38 +1997,293 @@ public:
         auto *const exit_block = helper.create_block_for_parent("while.exit");
 
         // Loop header
-        helper.create_br(cond_block);
-        val cond_val = emit(while_->condition);
-        helper.create_cond_br(get_operand(cond_val), body_block, exit_block);
+        // Note:
+        // The condition is evaluated on each iteration.  Its temporaries are in their own scope
+        // so that their lifetimes end before the branch.
+        auto *const entry_br = helper.create_br(cond_block);
+        ctx.allocator.enter_scope();
+        auto *const cond_val = get_operand(emit(while_->condition));
+        ctx.allocator.exit_scope();
+        helper.create_cond_br(cond_val, body_block, exit_block);
 
         // Loop body
-        auto const auto_popper = push_loop(cond_block);
-        emit(while_->body_stmts);
-        helper.terminate_with_br(cond_block, exit_block);
+        {
+            auto const auto_popper = push_loop(cond_block);
+            emit(while_->body_stmts);
+            helper.terminate_with_br(cond_block, exit_block);
+        }
+
+        emit_loop_metadata(cond_block, entry_br, while_->hints);
     }
 
-    void emit(ast::node::for_stmt const& for_)
+    // Note:
+    // Range is a first-class value.  Its step is 1 unless it is specified by step().
+    val emit_range(val const first_val, val const last_val)
+    {
+        auto *const range_type = llvm::StructType::get(ctx.llvm_context, {first_val->getType(), first_val->getType(), first_val->getType()});
+        val range_val = llvm::UndefValue::get(range_type);
+        range_val = ctx.builder.CreateInsertValue(range_val, first_val, 0u);
+        range_val = ctx.builder.CreateInsertValue(range_val, last_val, 1u);
+        return ctx.builder.CreateInsertValue(range_val, llvm::ConstantInt::get(first_val->getType(), 1u), 2u);
+    }
+
+    struct range_bounds {
+        llvm::Type *elem_ty;
+        val first;
+        val step;
+        val is_not_empty;
+        val last_index;
+    };
+
+    // Note:
+    // Loop over a range is lowered to the canonical induction loop which LLVM's loop
+    // optimizations (e.g. vectorization and unrolling) recognize.  The index of the last
+    // iteration is calculated before entering the loop and a 64bit counter runs from 0 to it.
+    // The iteration variable is derived from the counter as 'first + counter * step'.
+    // The number of iterations is not calculated because it is 2^64 for the full range of
+    // 64bit integer (e.g. 'int.min..int.max') and doesn't fit in 64bit.
+    range_bounds emit_range_bounds(val const range_val, type::range_type const& t)
+    {
+        bool const is_signed = t->element_type.is_builtin("int") || t->element_type.is_builtin("char");
+        auto *const i64_ty = ctx.builder.getInt64Ty();
+        auto const widen
+            = [&, this](auto *const v)
+            {
+                return is_signed ? ctx.builder.CreateSExtOrBitCast(v, i64_ty) : ctx.builder.CreateZExtOrBitCast(v, i64_ty);
+            };
+
+        auto *const elem_ty = range_val->getType()->getStructElementType(0u);
+        auto *const first_val = widen(ctx.builder.CreateExtractValue(range_val, 0u, "range.first"));
+        auto *const last_val = widen(ctx.builder.CreateExtractValue(range_val, 1u, "range.last"));
+        auto *const step_val = widen(ctx.builder.CreateExtractValue(range_val, 2u, "range.step"));
+
+        // Note:
+        // Non-positive step makes the range empty.  The divisor is replaced with 1 in the case
+        // because division by zero is undefined even if its result is not used.
+        auto *const zero_val = ctx.builder.getInt64(0u);
+        auto *const one_val = ctx.builder.getInt64(1u);
+        auto *const is_step_positive = is_signed ? ctx.builder.CreateICmpSGT(step_val, zero_val) : ctx.builder.CreateICmpNE(step_val, zero_val);
+        auto *const is_not_empty
+            = ctx.builder.CreateAnd(
+                    is_step_positive,
+                    t->is_inclusive ?
+                        (is_signed ? ctx.builder.CreateICmpSLE(first_val, last_val) : ctx.builder.CreateICmpULE(first_val, last_val)) :
+                        (is_signed ? ctx.builder.CreateICmpSLT(first_val, last_val) : ctx.builder.CreateICmpULT(first_val, last_val))
+                );
+
+        auto *const distance_val = ctx.builder.CreateSub(last_val, first_val);
+        auto *const last_index_val
+            = ctx.builder.CreateUDiv(
+                    t->is_inclusive ? distance_val : ctx.builder.CreateSub(distance_val, one_val),
+                    ctx.builder.CreateSelect(is_step_positive, step_val, one_val),
+                    "for.last_index"
+                );
+
+        return {elem_ty, first_val, step_val, is_not_empty, last_index_val};
+    }
+
+    // Note:
+    // Parallel for passes the number of iterations to the runtime.  It saturates
+    // at 2^64 - 1 for the full range of 64bit integer.
+    val emit_range_trip_count(range_bounds const& bounds)
+    {
+        auto *const max_val = ctx.builder.getInt64(std::numeric_limits<std::uint64_t>::max());
+        return ctx.builder.CreateSelect(
+                bounds.is_not_empty,
+                ctx.builder.CreateSelect(
+                    ctx.builder.CreateICmpEQ(bounds.last_index, max_val),
+                    max_val,
+                    ctx.builder.CreateNUWAdd(bounds.last_index, ctx.builder.getInt64(1u))
+                ),
+                ctx.builder.getInt64(0u),
+                "pfor.trip_count"
+            );
+    }
+
+    val emit_range_elem(range_bounds const& bounds, val const counter_val, std::string const& name)
+    {
+        return ctx.builder.CreateTruncOrBitCast(
+                ctx.builder.CreateAdd(bounds.first, ctx.builder.CreateMul(counter_val, bounds.step)),
+                bounds.elem_ty,
+                name
+            );
+    }
+
+    void emit_range_for(ast::node::for_stmt const& for_, type::range_type const& t)
     {
         auto helper = get_ir_helper(for_);
 
+        if (for_->iter_vars.size() != 1u) {
+            DACHS_RAISE_INTERNAL_COMPILATION_ERROR
+        }
+
+        auto const bounds = emit_range_bounds(get_operand(emit(for_->range_expr)), t);
+        auto *const counter_val = ctx.allocator.allocate(ctx.builder.getInt64Ty(), "for.i");
+        ctx.builder.CreateStore(ctx.builder.getInt64(0u), counter_val);
+
+        auto const& param = for_->iter_vars[0];
+        auto const sym = param->param_symbol;
+        auto *const allocated =
+            param->is_var ? ctx.allocator.allocate(bounds.elem_ty, param->name) : nullptr;
+
+        auto *const body_block = helper.create_block_for_parent("for.body");
+        auto *const footer_block = helper.create_block_for_parent("for.footer");
+
         // Note:
-        // Now array is only supported
+        // Emptiness is checked only on entering the loop.  The latch exits after the iteration
+        // of the last index so that the counter never needs to exceed it.
+        auto *const entry_br = helper.create_cond_br(bounds.is_not_empty, body_block, footer_block);
+
+        auto *const loaded_counter_val = ctx.builder.CreateLoad(counter_val, "for.i.loaded");
+
+        if (param->name != "_" || !sym.expired()) {
+            auto *const iter_val = emit_range_elem(bounds, loaded_counter_val, param->name);
+
+            if (allocated) {
+                ctx.builder.CreateStore(iter_val, allocated);
+                var_table.insert(sym.lock(), allocated);
+            } else {
+                var_table.insert(sym.lock(), iter_val);
+            }
+        }
+
+        emit(for_->body_stmts);
+
+        if (!ctx.builder.GetInsertBlock()->getTerminator()) {
+            ctx.builder.CreateStore(ctx.builder.CreateAdd(loaded_counter_val, ctx.builder.getInt64(1u)), counter_val);
+            helper.create_cond_br(
+                    ctx.builder.CreateICmpEQ(loaded_counter_val, bounds.last_index),
+                    footer_block,
+                    body_block,
+                    footer_block
+                );
+        } else {
+            ctx.builder.SetInsertPoint(footer_block);
+        }
+        emit_loop_metadata(body_block, entry_br, for_->hints);
+    }
+
+    // Note:
+    // Iterate all slots of the hash table and skip empty ones.
+    // Iteration variables refer to the key and the value in the table directly.
+    void emit_dict_for(ast::node::for_stmt const& for_, type::dict_type const& t)
+    {
+        auto helper = get_ir_helper(for_);
+
+        if (for_->iter_vars.size() != 2u) {
+            DACHS_RAISE_INTERNAL_COMPILATION_ERROR
+        }
+
+        auto *const dict_val = get_operand(emit(for_->range_expr));
+        auto *const entry_ptr_type = type_emitter.emit_dict_entry(t)->getPointerTo();
+        auto *const capacity_val = ctx.builder.CreateCall(builtin_func_emitter.emit_dict_capacity_func(), dict_val);
+        auto *const counter_val = ctx.allocator.allocate(ctx.builder.getInt64Ty(), "for.i");
+        ctx.builder.CreateStore(ctx.builder.getInt64(0u), counter_val);
+
+        auto *const header_block = helper.create_block_for_parent("for.header");
+        auto *const entry_block = helper.create_block_for_parent("for.entry");
+        auto *const body_block = helper.create_block_for_parent("for.body");
+        auto *const latch_block = helper.create_block_for_parent("for.latch");
+        auto *const footer_block = helper.create_block_for_parent("for.footer");
+
+        auto *const entry_br = helper.create_br(header_block);
+
+        auto *const loaded_counter_val = ctx.builder.CreateLoad(counter_val, "for.i.loaded");
+        helper.create_cond_br(
+                ctx.builder.CreateICmpULT(loaded_counter_val, capacity_val),
+                entry_block,
+                footer_block
+            );
+
+        auto *const entry_val = ctx.builder.CreateCall2(builtin_func_emitter.emit_dict_entry_at_func(), dict_val, loaded_counter_val);
+        helper.create_cond_br(ctx.builder.CreateIsNull(entry_val), latch_block, body_block, body_block);
+
+        auto *const typed_entry_val = ctx.builder.CreateBitCast(entry_val, entry_ptr_type);
+        for (auto const idx : helper::indices(for_->iter_vars.size())) {
+            auto const& param = for_->iter_vars[idx];
+            auto const sym = param->param_symbol;
+            if (param->name == "_" && sym.expired()) {
+                continue;
+            }
+
+            auto *const elem_ptr_val = ctx.builder.CreateStructGEP(typed_entry_val, idx, param->name);
+            if (param->is_var) {
+                auto *const allocated = ctx.allocator.allocate(type_emitter.emit(param->type), param->name);
+                helper.create_deep_copy(elem_ptr_val, allocated);
+                var_table.insert(sym.lock(), allocated);
+            } else {
+                var_table.insert(sym.lock(), elem_ptr_val);
+            }
+        }
+
+        emit(for_->body_stmts);
+        helper.terminate_with_br(latch_block, latch_block);
+
+        ctx.builder.CreateStore(ctx.builder.CreateNUWAdd(loaded_counter_val, ctx.builder.getInt64(1u)), counter_val);
+        helper.create_br(header_block, footer_block);
+        emit_loop_metadata(header_block, entry_br, for_->hints);
+    }
 
+    // Note:
+    // The range is iterated in place.  Variables, elements and parameters are already
+    // pointers to their storage.  Only a first-class array value needs a stack slot.
+    val emit_iterated_array(ast::node::for_stmt const& for_, bool const is_dynamic_array)
+    {
+        auto helper = get_ir_helper(for_);
         val range_val = emit(for_->range_expr);
-        if (!range_val->getType()->isPointerTy()) {
+
+        // Note:
+        // Elements of dynamically sized array are always in memory allocated by the runtime
+        if (!is_dynamic_array && !range_val->getType()->isPointerTy()) {
             if (auto *const a = llvm::dyn_cast<llvm::ConstantArray>(range_val)) {
-                range_val = new llvm::GlobalVariable(*module, a->getType(), true, llvm::GlobalVariable::PrivateLinkage, a);
+                range_val = get_constant_array_storage(a);
             } else {
-                range_val = helper.alloc_and_deep_copy(range_val);
+                auto *const allocated = check(for_, helper.create_alloca(range_val), "allocation for range of for statement");
+                helper.create_deep_copy(range_val, allocated);
+                range_val = allocated;
             }
         }
 
-        assert(range_val->getType()->isPointerTy());
-        assert(range_val->getType()->getPointerElementType()->isArrayTy());
+        assert(is_dynamic_array || range_val->getType()->isPointerTy());
+        assert(is_dynamic_array || range_val->getType()->getPointerElementType()->isArrayTy());
+        return range_val;
+    }
+
+    void emit(ast::node::for_stmt const& for_)
+    {
+        if (for_->is_parallel()) {
+            emit_parallel_for(for_);
+            return;
+        }
+
+        if (auto const dict_type = type::get<type::dict_type>(type::type_of(for_->range_expr))) {
+            emit_dict_for(for_, *dict_type);
+            return;
+        }
+
+        if (auto const range_type = type::get<type::range_type>(type::type_of(for_->range_expr))) {
+            emit_range_for(for_, *range_type);
+            return;
+        }
+
+        auto helper = get_ir_helper(for_);
 
-        auto *const range_size_val = ctx.builder.getInt32(range_val->getType()->getPointerElementType()->getArrayNumElements());
-        auto *const counter_val = ctx.builder.CreateAlloca(ctx.builder.getInt32Ty(), nullptr, "for.i");
-        ctx.builder.CreateStore(ctx.builder.getInt32(0u), counter_val);
+        // Note:
+        // Now array, dictionary and range are only supported
+        auto const range_type = type::get<type::array_type>(type::type_of(for_->range_expr));
+        assert(range_type);
+        bool const is_dynamic_array = !(*range_type)->size;
+        auto *const range_val = emit_iterated_array(for_, is_dynamic_array);
+
+        // Note:
+        // The induction variable is a 64bit index so that loop optimizations (e.g. vectorization)
+        // don't need to extend it for GEP.
+        auto *const range_size_val
+            = is_dynamic_array ?
+                dynamic_array_ir_emitter{ctx}.emit_size(range_val) :
+                ctx.builder.getInt64(range_val->getType()->getPointerElementType()->getArrayNumElements());
+        auto *const counter_val = ctx.allocator.allocate(ctx.builder.getInt64Ty(), "for.i");
+        ctx.builder.CreateStore(ctx.builder.getInt64(0u), counter_val);
 
         if (for_->iter_vars.size() != 1u) {
             DACHS_RAISE_INTERNAL_COMPILATION_ERROR
@@ -1028,16 +2293,29 @@ public:
         auto const sym = param->param_symbol;
         auto const iter_t = type_emitter.emit(param->type);
         auto *const allocated =
-            param->is_var ? ctx.builder.CreateAlloca(iter_t, nullptr, param->name) : nullptr;
+            param->is_var ? ctx.allocator.allocate(iter_t, param->name) : nullptr;
 
         // Note:
         // Do not emit parameter by emit(ast::node::parameter const&)
 
+        // Note:
+        // The pointer to elements is loaded only once unless the body may reallocate them.
+        // Loop optimizations can't hoist the load by themselves because stores to elements
+        // may alias the array object.
+        elems_reallocation_finder finder{semantics_ctx.func_effects};
+        if (is_dynamic_array) {
+            ast::walk_topdown(for_->body_stmts, finder);
+        }
+        auto *const hoisted_elems_val
+            = is_dynamic_array && !finder.found ?
+                emit_dynamic_array_elems(range_val, *range_type) :
+                nullptr;
+
         auto *const header_block = helper.create_block_for_parent("for.header");
         auto *const body_block = helper.create_block_for_parent("for.body");
         auto *const footer_block = helper.create_block_for_parent("for.footer");
 
-        helper.create_br(header_block);
+        auto *const entry_br = helper.create_br(header_block);
 
         auto *const loaded_counter_val = ctx.builder.CreateLoad(counter_val, "for.i.loaded");
         helper.create_cond_br(
@@ -1051,19 +2329,27 @@ public:
 
         if (param->name != "_" || !sym.expired()) {
             auto *const elem_ptr_val =
-                ctx.builder.CreateInBoundsGEP(
-                    range_val,
-                    (val [2]){
-                        ctx.builder.getInt32(0u),
-                        loaded_counter_val
-                    },
-                    param->name
-                );
+                is_dynamic_array ?
+                    ctx.builder.CreateInBoundsGEP(
+                        hoisted_elems_val ? hoisted_elems_val : emit_dynamic_array_elems(range_val, *range_type),
+                        loaded_counter_val,
+                        param->name
+                    ) :
+                    ctx.builder.CreateInBoundsGEP(
+                        range_val,
+                        (val [2]){
+                            ctx.builder.getInt64(0u),
+                            loaded_counter_val
+                        },
+                        param->name
+                    );
 
             if (allocated) {
                 helper.create_deep_copy(elem_ptr_val, allocated);
                 var_table.insert(sym.lock(), allocated);
             } else {
+                // Note:
+                // Immutable loop variable refers to the element directly
                 var_table.insert(sym.lock(), elem_ptr_val);
                 elem_ptr_val->setName(param->name);
             }
@@ -1071,8 +2357,216 @@ public:
 
         emit(for_->body_stmts);
 
-        ctx.builder.CreateStore(ctx.builder.CreateAdd(loaded_counter_val, ctx.builder.getInt32(1u)), counter_val);
-        helper.create_br(header_block, footer_block);
+        if (!ctx.builder.GetInsertBlock()->getTerminator()) {
+            ctx.builder.CreateStore(ctx.builder.CreateNUWAdd(loaded_counter_val, ctx.builder.getInt64(1u)), counter_val);
+        }
+        helper.terminate_with_br(header_block, footer_block);
+        emit_loop_metadata(header_block, entry_br, for_->hints);
+    }
+
+    // Note:
+    // The body of parallel for is outlined into a function which iterates indices in
+    // [begin, end) and the runtime runs parts of the index space on its thread pool.
+    //   void @{enclosing function}.pfor(i8* env, i64 begin, i64 end)
+    // The environment has values to derive elements (first and step of the range, or
+    // elements of the array) followed by the variables which the body refers to.
+    // Variables in memory are passed by their addresses, so elements written in the body
+    // are shared with the caller.  Semantic analysis ensures that the body doesn't modify
+    // the variables themselves.
+    void emit_parallel_for(ast::node::for_stmt const& for_)
+    {
+        if (for_->iter_vars.size() != 1u) {
+            DACHS_RAISE_INTERNAL_COMPILATION_ERROR
+        }
+
+        auto const range_t = type::type_of(for_->range_expr);
+        auto const range_type = type::get<type::range_type>(range_t);
+        auto const array_type = type::get<type::array_type>(range_t);
+        if (!range_type && !array_type) {
+            error(for_, "Range of parallel for must be array or range");
+        }
+
+        std::vector<val> env_vals;
+        val trip_count_val = nullptr;
+        llvm::Type *range_elem_ty = nullptr;
+
+        if (range_type) {
+            auto const bounds = emit_range_bounds(get_operand(emit(for_->range_expr)), *range_type);
+            env_vals = {bounds.first, bounds.step};
+            trip_count_val = emit_range_trip_count(bounds);
+            range_elem_ty = bounds.elem_ty;
+        } else if (!(*array_type)->size) {
+            auto *const array_val = emit_iterated_array(for_, true);
+            env_vals = {emit_dynamic_array_elems(array_val, *array_type)};
+            trip_count_val = dynamic_array_ir_emitter{ctx}.emit_size(array_val);
+        } else {
+            auto *const array_val = emit_iterated_array(for_, false);
+            env_vals = {array_val};
+            trip_count_val = ctx.builder.getInt64(array_val->getType()->getPointerElementType()->getArrayNumElements());
+        }
+        auto const num_loop_fields = env_vals.size();
+
+        referred_vars_collector collector{semantics_ctx.lambda_instantiation_map};
+        ast::walk_topdown(for_->body_stmts, collector);
+
+        // Note:
+        // Variables declared in the body are not in the table yet
+        std::vector<std::pair<symbol::var_symbol, bool>> captures;
+        for (auto const& sym : collector.vars) {
+            if (auto *const v = var_table.lookup_value(sym)) {
+                captures.emplace_back(sym, is_address(v));
+                env_vals.push_back(v);
+            }
+        }
+
+        std::vector<llvm::Type *> field_types;
+        for (auto *const v : env_vals) {
+            field_types.push_back(v->getType());
+        }
+        auto *const env_type = llvm::StructType::get(ctx.llvm_context, field_types);
+        auto *const env_val = ctx.allocator.allocate(env_type, "pfor.env");
+        for (auto const idx : helper::indices(env_vals.size())) {
+            ctx.builder.CreateStore(env_vals[idx], ctx.builder.CreateStructGEP(env_val, idx));
+        }
+
+        auto *const body_func = emit_parallel_for_body(for_, env_type, num_loop_fields, captures, range_elem_ty);
+
+        ctx.builder.CreateCall3(
+                builtin_func_emitter.emit_parallel_for_func(),
+                body_func,
+                ctx.builder.CreateBitCast(env_val, ctx.builder.getInt8PtrTy()),
+                trip_count_val
+            );
+    }
+
+    template<class Captures>
+    llvm::Function *emit_parallel_for_body(
+            ast::node::for_stmt const& for_,
+            llvm::StructType *const env_type,
+            std::size_t const num_loop_fields,
+            Captures const& captures,
+            llvm::Type *const range_elem_ty)
+    {
+        auto *const caller_block = ctx.builder.GetInsertBlock();
+        auto *const body_func = llvm::Function::Create(
+                builtin_func_emitter.emit_parallel_for_body_type(),
+                llvm::Function::InternalLinkage,
+                caller_block->getParent()->getName() + ".pfor",
+                module
+            );
+        body_func->addFnAttr(llvm::Attribute::NoUnwind);
+
+        auto arg_itr = body_func->arg_begin();
+        auto *const env_arg = &*arg_itr++;
+        auto *const begin_arg = &*arg_itr++;
+        auto *const end_arg = &*arg_itr;
+        env_arg->setName("env");
+        begin_arg->setName("begin");
+        end_arg->setName("end");
+
+        // Note:
+        // The outlined function doesn't return a value and only sees its own variables
+        auto *const saved_result_slot = result_slot;
+        result_slot = nullptr;
+        variable_table body_vars{ctx};
+        var_table.swap(body_vars);
+
+        ctx.builder.SetInsertPoint(llvm::BasicBlock::Create(ctx.llvm_context, "entry", body_func));
+        ctx.allocator.enter_function(body_func);
+        auto helper = get_ir_helper(for_);
+
+        auto *const env = ctx.builder.CreateBitCast(env_arg, env_type->getPointerTo());
+        auto const load_field
+            = [&, this](std::size_t const idx, std::string const& name)
+            {
+                return ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(env, idx), name);
+            };
+
+        // Note:
+        // An address is wrapped with GEP to be treated as a variable in memory (see get_operand())
+        for (auto const idx : helper::indices(captures.size())) {
+            auto const& sym = captures[idx].first;
+            auto *const loaded = load_field(num_loop_fields + idx, sym->name);
+            var_table.insert(
+                    sym,
+                    captures[idx].second ?
+                        ctx.builder.CreateConstInBoundsGEP1_32(loaded, 0u, sym->name) :
+                        static_cast<val>(loaded)
+                );
+        }
+
+        std::vector<val> loop_vals;
+        for (auto const idx : helper::indices(num_loop_fields)) {
+            loop_vals.push_back(load_field(idx, "pfor.field"));
+        }
+
+        auto *const counter_val = ctx.allocator.allocate(ctx.builder.getInt64Ty(), "pfor.i");
+        ctx.builder.CreateStore(begin_arg, counter_val);
+
+        auto const& param = for_->iter_vars[0];
+        auto const sym = param->param_symbol;
+        auto *const allocated =
+            param->is_var ? ctx.allocator.allocate(type_emitter.emit(param->type), param->name) : nullptr;
+
+        auto *const header_block = helper.create_block_for_parent("pfor.header");
+        auto *const body_block = helper.create_block_for_parent("pfor.body");
+        auto *const footer_block = helper.create_block_for_parent("pfor.footer");
+
+        auto *const entry_br = helper.create_br(header_block);
+
+        auto *const loaded_counter_val = ctx.builder.CreateLoad(counter_val, "pfor.i.loaded");
+        helper.create_cond_br(
+                ctx.builder.CreateICmpULT(loaded_counter_val, end_arg),
+                body_block,
+                footer_block
+            );
+
+        if (param->name != "_" || !sym.expired()) {
+            if (range_elem_ty) {
+                auto *const iter_val = emit_range_elem({range_elem_ty, loop_vals[0], loop_vals[1], nullptr, nullptr}, loaded_counter_val, param->name);
+                if (allocated) {
+                    ctx.builder.CreateStore(iter_val, allocated);
+                    var_table.insert(sym.lock(), allocated);
+                } else {
+                    var_table.insert(sym.lock(), iter_val);
+                }
+            } else {
+                auto *const elem_ptr_val =
+                    loop_vals[0]->getType()->getPointerElementType()->isArrayTy() ?
+                        ctx.builder.CreateInBoundsGEP(
+                            loop_vals[0],
+                            (val [2]){
+                                ctx.builder.getInt64(0u),
+                                loaded_counter_val
+                            },
+                            param->name
+                        ) :
+                        ctx.builder.CreateInBoundsGEP(loop_vals[0], loaded_counter_val, param->name);
+
+                if (allocated) {
+                    helper.create_deep_copy(elem_ptr_val, allocated);
+                    var_table.insert(sym.lock(), allocated);
+                } else {
+                    var_table.insert(sym.lock(), elem_ptr_val);
+                }
+            }
+        }
+
+        emit(for_->body_stmts);
+
+        if (!ctx.builder.GetInsertBlock()->getTerminator()) {
+            ctx.builder.CreateStore(ctx.builder.CreateNUWAdd(loaded_counter_val, ctx.builder.getInt64(1u)), counter_val);
+        }
+        helper.terminate_with_br(header_block, footer_block);
+        ctx.builder.CreateRetVoid();
+        emit_loop_metadata(header_block, entry_br, for_->hints);
+
+        ctx.allocator.exit_function();
+        var_table.swap(body_vars);
+        result_slot = saved_result_slot;
+        ctx.builder.SetInsertPoint(caller_block);
+
+        return body_func;
     }
 
     void emit(ast::node::initialize_stmt const& init)
@@ -1083,7 +2577,7 @@ public:
                 auto const sym = d->symbol.lock();
                 assert(d->maybe_type);
                 auto const type_ir = type_emitter.emit(sym->type);
-                auto *const allocated = ctx.builder.CreateAlloca(type_ir, nullptr, sym->name);
+                auto *const allocated = ctx.allocator.allocate(type_ir, sym->name);
                 ctx.builder.CreateMemSet(
                         allocated,
                         ctx.builder.getInt8(0u),
@@ -1104,7 +2598,7 @@ public:
         assert(initializer_size != 0);
 
         auto const initialize
-            = [&, this](auto const& decl, auto *const value)
+            = [&, this](auto const& decl, auto *const value, bool const temporary)
             {
                 if (decl->name == "_" && decl->symbol.expired()) {
                     return;
@@ -1114,6 +2608,15 @@ public:
 
                 auto const sym = decl->symbol.lock();
                 if (decl->is_var) {
+                    // Note:
+                    // The temporary is already constructed in its own stack slot.
+                    // Use the slot as the variable's storage instead of copying it.
+                    auto *const slot = llvm::dyn_cast<llvm::AllocaInst>(value);
+                    if (temporary && slot) {
+                        var_table.insert(std::move(sym), slot);
+                        return;
+                    }
+
                     auto *const allocated = helper.alloc_and_deep_copy(value, sym->name);
                     var_table.insert(std::move(sym), allocated);
                 } else {
@@ -1126,7 +2629,8 @@ public:
             helper::each(
                     [&, this](auto const& d, auto const& e)
                     {
-                        initialize(d, emit(e));
+                        auto const owned = !d->symbol.expired() && owns_string(d->symbol.lock());
+                        initialize(d, owned ? emit_owned_string(e) : emit(e), is_temporary(e));
                     }
                     , init->var_decls, rhs_exprs
                 );
@@ -1136,7 +2640,7 @@ public:
             auto *const rhs_tuple_value
                 = emit_tuple_constant(rhs_exprs);
 
-            initialize(init->var_decls[0], rhs_tuple_value);
+            initialize(init->var_decls[0], rhs_tuple_value, true);
         } else if (initializer_size == 1) {
             assert(initializee_size > 1);
             auto const& rhs_expr = (rhs_exprs)[0];
@@ -1165,7 +2669,14 @@ public:
                 }
             }
 
-            helper::each(initialize , init->var_decls, rhs_values);
+            bool const temporary = is_temporary(rhs_expr);
+            helper::each(
+                    [&](auto const& d, auto *const v)
+                    {
+                        initialize(d, v, temporary);
+                    }
+                    , init->var_decls, rhs_values
+                );
         } else {
             DACHS_RAISE_INTERNAL_COMPILATION_ERROR
         }
@@ -1183,6 +2694,7 @@ public:
         auto const assigner_size = assign->rhs_exprs.size();
         auto const is_compound_assign = assign->op != "=";
         assert(assignee_size > 0 && assigner_size > 0);
+        std::vector<std::vector<val>> appended_strings(assignee_size);
 
         if (assignee_size == assigner_size) {
             helper::each(
@@ -1191,7 +2703,17 @@ public:
                         if (is_compound_assign && !is_available_type_for_binary_expression(type::type_of(lhs), type::type_of(rhs))) {
                             error(assign, "Binary expression now only supports float, int, bool and uint");
                         }
-                        rhs_values.push_back(emit(rhs));
+
+                        if (assign->op == "+=" && type::type_of(lhs).is_builtin("string")) {
+                            // Note:
+                            // 's += a + b' appends all operands to 's' at once
+                            collect_concat_operands(rhs, appended_strings[rhs_values.size()]);
+                            rhs_values.push_back(nullptr);
+                        } else if (!is_compound_assign && owns_string(lhs)) {
+                            rhs_values.push_back(emit_owned_string(rhs));
+                        } else {
+                            rhs_values.push_back(emit(rhs));
+                        }
                     }, assign->assignees, assign->rhs_exprs);
         } else if (assigner_size == 1) {
             assert(assignee_size > 1);
@@ -1209,7 +2731,7 @@ public:
         assert(assignee_size == rhs_values.size());
 
         auto const assignment_emitter =
-            [&, this](auto const& lhs_expr, auto *const rhs_value)
+            [&, this](auto const& lhs_expr, auto *const rhs_value, std::vector<val> const& appended)
             {
                 val value_to_assign = rhs_value;
 
@@ -1222,7 +2744,14 @@ public:
 
                 assert(lhs_value->getType()->isPointerTy());
 
-                if (is_compound_assign) {
+                if (!appended.empty()) {
+                    // Note:
+                    // When 's' is the result of the previous concatenation, the runtime
+                    // appends the operands in place.  So 's += t' in a loop is amortized O(n).
+                    std::vector<val> operands = {lhs_value};
+                    operands.insert(std::end(operands), std::begin(appended), std::end(appended));
+                    value_to_assign = check(assign, string_ir_emitter{ctx}.emit_concat(operands, owns_string(lhs_expr)), "string concatenation");
+                } else if (is_compound_assign) {
                     auto const bin_op = assign->op.substr(0, assign->op.size()-1);
                     auto const lhs_type = type::type_of(lhs_expr);
                     value_to_assign =
@@ -1243,7 +2772,9 @@ public:
                 helper.create_deep_copy(value_to_assign, lhs_value);
             };
 
-        helper::each(assignment_emitter, assign->assignees, rhs_values);
+        for (auto const idx : helper::indices(assignee_size)) {
+            assignment_emitter(assign->assignees[idx], rhs_values[idx], appended_strings[idx]);
+        }
     }
 
     void emit(ast::node::case_stmt const& case_)
@@ -1270,6 +2801,96 @@ public:
         helper.append_block(end_block);
     }
 
+    // Note:
+    // Return the integer constant for 'when' value if it is known at compile time.
+    // Constant expressions are already folded into literals by the constant evaluator.
+    llvm::ConstantInt *emit_switch_case_constant(ast::node::any_expr const& e)
+    {
+        if (auto const sym = get_as<ast::node::symbol_literal>(e)) {
+            return ctx.builder.getInt64(intern_symbol((*sym)->value).first);
+        }
+
+        if (auto const lit = get_as<ast::node::primary_literal>(e)) {
+            return llvm::dyn_cast<llvm::ConstantInt>(emit(*lit));
+        }
+
+        return nullptr;
+    }
+
+    /*
+     * When all 'when' values are integer, char or symbol constants, switch statement
+     * is lowered to switch instruction.  The backend can build a jump table or a binary
+     * search from it instead of comparing values one by one.
+     *
+     * - IR
+     *   switch v, label lelse [ a, label lthen ; b, label lthen ]
+     *   lthen:
+     *   ; body
+     *   br lend
+     *   lelse:
+     */
+    bool emit_switch_inst(ast::node::switch_stmt const& switch_, val const target_val, type::type const& target_type)
+    {
+        bool const is_symbol = target_type.is_builtin("symbol");
+        if (!is_symbol
+            && !target_type.is_builtin("int")
+            && !target_type.is_builtin("uint")
+            && !target_type.is_builtin("char")) {
+            return false;
+        }
+
+        std::vector<std::vector<llvm::ConstantInt *>> case_vals_list;
+        std::size_t num_cases = 0u;
+        for (auto const& when_stmt : switch_->when_stmts_list) {
+            std::vector<llvm::ConstantInt *> case_vals;
+            for (auto const& cmp_expr : when_stmt.first) {
+                auto *const case_val = emit_switch_case_constant(cmp_expr);
+                if (!case_val) {
+                    return false;
+                }
+                case_vals.push_back(case_val);
+            }
+            num_cases += case_vals.size();
+            case_vals_list.push_back(std::move(case_vals));
+        }
+
+        auto helper = get_ir_helper(switch_);
+        auto *const end_block = helper.create_block("switch.end");
+        auto *const else_block = helper.create_block("switch.else");
+        auto *const switch_inst
+            = ctx.builder.CreateSwitch(
+                is_symbol ? emit_symbol_id(target_val) : target_val,
+                else_block,
+                num_cases
+            );
+
+        // Note:
+        // When the same value appears in multiple 'when' clauses, the first one is taken
+        // as the comparison chain does.
+        std::unordered_set<llvm::ConstantInt *> emitted_vals;
+        for (auto const idx : helper::indices(switch_->when_stmts_list.size())) {
+            auto *const then_block = helper.create_block("switch.then");
+            for (auto *const case_val : case_vals_list[idx]) {
+                if (emitted_vals.insert(case_val).second) {
+                    switch_inst->addCase(case_val, then_block);
+                }
+            }
+
+            helper.append_block(then_block);
+            emit(switch_->when_stmts_list[idx].second);
+            helper.terminate_with_br(end_block);
+        }
+
+        helper.append_block(else_block);
+        if (switch_->maybe_else_stmts) {
+            emit(*switch_->maybe_else_stmts);
+        }
+        helper.terminate_with_br(end_block);
+
+        helper.append_block(end_block);
+        return true;
+    }
+
     /*
      * - statement
      *   case v
@@ -1277,7 +2898,7 @@ public:
      *   else
      *   end
      *
-     * - IR
+     * - IR (when some of 'when' values are not constant)
      *   ; emit a
      *   v == a ? br lthen : br l1
      *   l1:
@@ -1291,12 +2912,16 @@ public:
      */
     void emit(ast::node::switch_stmt const& switch_)
     {
-        auto helper = get_ir_helper(switch_);
-        auto *const end_block = helper.create_block("switch.end");
-
         auto *const target_val = get_operand(emit(switch_->target_expr));
         auto const target_type = type::type_of(switch_->target_expr);
 
+        if (emit_switch_inst(switch_, target_val, target_type)) {
+            return;
+        }
+
+        auto helper = get_ir_helper(switch_);
+        auto *const end_block = helper.create_block("switch.end");
+
         // Emit when clause
         llvm::BasicBlock *else_block;
         for (auto const& when_stmt : switch_->when_stmts_list) {
@@ -1482,7 +3107,12 @@ public:
             arg_vals.push_back(get_operand(emit(e)));
         }
 
-        return check(obj, ctor_emitter.emit(obj->type, arg_vals), "object construction");
+        auto const escape = semantics_ctx.escapes.allocations.find(obj);
+        auto const frame_local
+            = escape != std::end(semantics_ctx.escapes.allocations)
+                && escape->second == semantics::escape_kind::none;
+
+        return check(obj, ctor_emitter.emit(obj->type, arg_vals, frame_local), "object construction");
     }
 
     template<class T>
@@ -1502,6 +3132,23 @@ llvm::Module &emit_llvm_ir(ast::ast const& a, semantics::semantics_context const
         helper::colorizer<std::string> c;
         std::cerr << c.red(errmsg) << std::endl;
     }
+
+#if defined DACHS_ENABLE_STATS
+    for (auto const& f : the_module) {
+        if (f.isDeclaration()) {
+            continue;
+        }
+
+        std::size_t num_insts = 0u;
+        for (auto const& b : f) {
+            num_insts += b.size();
+        }
+
+        DACHS_STATS_ADD("codegen.basic_blocks." + f.getName().str(), f.size());
+        DACHS_STATS_ADD("codegen.instructions." + f.getName().str(), num_insts);
+    }
+#endif
+
     return the_module;
 }
 
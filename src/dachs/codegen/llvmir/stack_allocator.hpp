@@ -0,0 +1,206 @@
+#if !defined DACHS_CODEGEN_LLVMIR_STACK_ALLOCATOR_HPP_INCLUDED
+#define      DACHS_CODEGEN_LLVMIR_STACK_ALLOCATOR_HPP_INCLUDED
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <unordered_map>
+#include <cassert>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Constants.h>
+
+namespace dachs {
+namespace codegen {
+namespace llvmir {
+
+// Note:
+// All stack slots are allocated in the entry block of the function because an alloca
+// in a loop body allocates a new slot on every iteration and prevents mem2reg and SROA.
+// Slots allocated in a lexical scope are released at the end of the scope with
+// llvm.lifetime.end and reused by later allocations of the same type in the function.
+// A slot which owns a resource (see allocate_owner()) is never reused.
+class stack_allocator {
+    llvm::IRBuilder<> &builder;
+    llvm::DataLayout const* const data_layout;
+
+    struct function_frame {
+        llvm::Function *function;
+        std::unordered_map<llvm::Type *, std::vector<llvm::AllocaInst *>> free_slots;
+        std::vector<std::vector<llvm::AllocaInst *>> scopes;
+        std::vector<std::pair<llvm::AllocaInst *, llvm::Function *>> owners;
+    };
+
+    std::vector<function_frame> frames;
+
+    llvm::ConstantInt *size_of(llvm::AllocaInst *const slot) const
+    {
+        return builder.getInt64(data_layout->getTypeAllocSize(slot->getAllocatedType()));
+    }
+
+    template<class String>
+    llvm::AllocaInst *create_entry_alloca(llvm::Function *const func, llvm::Type *const type, String const& name) const
+    {
+        auto &entry = func->getEntryBlock();
+        llvm::IRBuilder<> entry_builder(&entry, entry.begin());
+        return entry_builder.CreateAlloca(type, nullptr, name);
+    }
+
+public:
+
+    stack_allocator(llvm::IRBuilder<> &b, llvm::DataLayout const* const dl) noexcept
+        : builder(b), data_layout(dl)
+    {}
+
+    void enter_function(llvm::Function *const func)
+    {
+        frames.push_back({func, {}, {}, {}});
+    }
+
+    // Note:
+    // Must be called after all 'ret' of the function are emitted and tail calls are
+    // eliminated (see tail_call_optimizer).  Slots which own resources are initialized
+    // where they are allocated, so they are initialized only once even if the function
+    // jumps back to its head.
+    void exit_function()
+    {
+        assert(!frames.empty());
+        auto &frame = frames.back();
+        assert(frame.scopes.empty());
+
+        for (auto const& owner : frame.owners) {
+            new llvm::StoreInst(
+                    llvm::Constant::getNullValue(owner.first->getAllocatedType()),
+                    owner.first,
+                    &*std::next(llvm::BasicBlock::iterator(owner.first))
+                );
+        }
+
+        if (!frame.owners.empty()) {
+            for (auto &block : *frame.function) {
+                auto *const ret = llvm::dyn_cast_or_null<llvm::ReturnInst>(block.getTerminator());
+                if (!ret) {
+                    continue;
+                }
+
+                for (auto const& owner : frame.owners) {
+                    llvm::CallInst::Create(owner.second, owner.first, "", ret);
+                }
+            }
+        }
+
+        frames.pop_back();
+    }
+
+    void enter_scope()
+    {
+        if (frames.empty()) {
+            return;
+        }
+        frames.back().scopes.emplace_back();
+    }
+
+    void exit_scope()
+    {
+        if (frames.empty()) {
+            return;
+        }
+
+        auto &frame = frames.back();
+        assert(!frame.scopes.empty());
+
+        // Note:
+        // When the current block is already terminated by 'ret', the lifetimes were ended
+        // before it (see end_scopes_for_return()).  The slots of a scope exited by other
+        // terminator are not reused because their lifetimes never end on the path.
+        auto *const current_block = builder.GetInsertBlock();
+        auto *const terminator = current_block ? current_block->getTerminator() : nullptr;
+
+        for (auto *const slot : frame.scopes.back()) {
+            if (!terminator) {
+                builder.CreateLifetimeEnd(slot, size_of(slot));
+            } else if (!llvm::isa<llvm::ReturnInst>(terminator)) {
+                continue;
+            }
+            frame.free_slots[slot->getAllocatedType()].push_back(slot);
+        }
+
+        frame.scopes.pop_back();
+    }
+
+    // Note:
+    // Ends the lifetimes of the slots in all scopes of the function before 'ret'.
+    // The scopes themselves are exited when their statements are all emitted.
+    void end_scopes_for_return()
+    {
+        auto *const current_block = builder.GetInsertBlock();
+        if (frames.empty() || !current_block || frames.back().function != current_block->getParent()) {
+            return;
+        }
+
+        for (auto const& scope : frames.back().scopes) {
+            for (auto *const slot : scope) {
+                builder.CreateLifetimeEnd(slot, size_of(slot));
+            }
+        }
+    }
+
+    template<class String = char const* const>
+    llvm::AllocaInst *allocate(llvm::Type *const type, String const& name = "")
+    {
+        auto *const current_block = builder.GetInsertBlock();
+        assert(current_block);
+        auto *const func = current_block->getParent();
+
+        if (frames.empty() || frames.back().function != func || frames.back().scopes.empty()) {
+            // Note:
+            // Out of any scope (e.g. copies of parameters).  The slot lives until the end of the function.
+            return create_entry_alloca(func, type, name);
+        }
+
+        auto &frame = frames.back();
+        auto &pool = frame.free_slots[type];
+
+        llvm::AllocaInst *slot = nullptr;
+        if (pool.empty()) {
+            slot = create_entry_alloca(func, type, name);
+        } else {
+            slot = pool.back();
+            pool.pop_back();
+        }
+
+        builder.CreateLifetimeStart(slot, size_of(slot));
+        frame.scopes.back().push_back(slot);
+        return slot;
+    }
+
+    // Note:
+    // The slot is zero-initialized at the entry of the function and 'release' is called with
+    // it before every 'ret' (see exit_function()).  Returns nullptr out of any function because
+    // nothing can release the slot.
+    template<class String = char const* const>
+    llvm::AllocaInst *allocate_owner(llvm::Type *const type, llvm::Function *const release, String const& name = "")
+    {
+        auto *const current_block = builder.GetInsertBlock();
+        assert(current_block);
+        auto *const func = current_block->getParent();
+
+        if (frames.empty() || frames.back().function != func) {
+            return nullptr;
+        }
+
+        auto *const slot = create_entry_alloca(func, type, name);
+        frames.back().owners.emplace_back(slot, release);
+        return slot;
+    }
+};
+
+} // namespace llvmir
+} // namespace codegen
+} // namespace dachs
+
+#endif    // DACHS_CODEGEN_LLVMIR_STACK_ALLOCATOR_HPP_INCLUDED
@@ -0,0 +1,183 @@
+#if !defined DACHS_CODEGEN_LLVMIR_STRING_IR_EMITTER_HPP_INCLUDED
+#define      DACHS_CODEGEN_LLVMIR_STRING_IR_EMITTER_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include <llvm/IR/Value.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/DerivedTypes.h>
+
+#include "dachs/codegen/llvmir/context.hpp"
+#include "dachs/codegen/llvmir/builtin_func_ir_emitter.hpp"
+#include "dachs/helper/util.hpp"
+
+namespace dachs {
+namespace codegen {
+namespace llvmir {
+
+// Note:
+// A string value is a pair of the pointer to its characters and its length: { i8*, i64 }.
+// Characters are not terminated by '\0'.  Strings are immutable, so a slice shares the
+// characters of its source and copying a string copies only the pair.
+// A zero-initialized value ({ null, 0 }) is an empty string.
+class string_ir_emitter {
+    context &ctx;
+    builtin_function_emitter builtin_func_emitter;
+
+    using val = llvm::Value *;
+
+public:
+
+    static llvm::StructType *get_type(llvm::LLVMContext &c)
+    {
+        return llvm::StructType::get(c, {llvm::Type::getInt8PtrTy(c), llvm::Type::getInt64Ty(c)});
+    }
+
+    explicit string_ir_emitter(context &c)
+        : ctx(c), builtin_func_emitter(c.llvm_context)
+    {
+        assert(ctx.builder.GetInsertBlock());
+        builtin_func_emitter.set_module(ctx.builder.GetInsertBlock()->getParent()->getParent());
+    }
+
+    llvm::Constant *emit_constant(std::string const& s)
+    {
+        // Note:
+        // StringRef keeps '\0' in the string.  The terminator added to the global
+        // is not included in the length.
+        auto *const chars = llvm::cast<llvm::Constant>(ctx.builder.CreateGlobalStringPtr(s));
+        return llvm::ConstantStruct::get(get_type(ctx.llvm_context), {chars, ctx.builder.getInt64(s.size())});
+    }
+
+    // Note:
+    // A string variable is a pointer to the pair
+    val emit_value(val const s)
+    {
+        return s->getType()->isPointerTy() ? ctx.builder.CreateLoad(s) : s;
+    }
+
+    val emit_chars(val const s)
+    {
+        return s->getType()->isPointerTy() ?
+            ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(s, 0u), "str.ptr") :
+            ctx.builder.CreateExtractValue(s, 0u, "str.ptr");
+    }
+
+    val emit_length(val const s)
+    {
+        return s->getType()->isPointerTy() ?
+            ctx.builder.CreateLoad(ctx.builder.CreateStructGEP(s, 1u), "str.len") :
+            ctx.builder.CreateExtractValue(s, 1u, "str.len");
+    }
+
+    val emit_make(val const chars, val const length)
+    {
+        auto *const pair = ctx.builder.CreateInsertValue(llvm::UndefValue::get(get_type(ctx.llvm_context)), chars, 0u);
+        return ctx.builder.CreateInsertValue(pair, length, 1u);
+    }
+
+    val emit_char_at(val const s, val const index)
+    {
+        return ctx.builder.CreateLoad(ctx.builder.CreateInBoundsGEP(emit_chars(s), to_int64(index)), "str.char");
+    }
+
+    // Note:
+    // A slice refers to the characters of the source string.  No character is copied.
+    // Like index access to an array, the range is not checked.
+    val emit_slice(val const s, val const begin, val const end)
+    {
+        auto *const begin_val = to_int64(begin);
+        return emit_make(
+                ctx.builder.CreateInBoundsGEP(emit_chars(s), begin_val),
+                ctx.builder.CreateSub(to_int64(end), begin_val, "str.slice.len")
+            );
+    }
+
+    // Note:
+    // All operands are passed to the runtime at once.  The runtime allocates the result
+    // only once and appends to the result of the previous concatenation in place if possible.
+    // The slot of the result owns the buffer of the result (see runtime/string.cpp).  When the
+    // result can't be referred after the next concatenation at the same place or the end of the
+    // function ('owned' is true), the slot is dedicated to the concatenation and releases the
+    // previous result on each concatenation and at the end of the function.  Otherwise the
+    // buffer is never released like other objects which may escape to heap.
+    val emit_concat(std::vector<val> const& strings, bool const owned = false)
+    {
+        assert(!strings.empty());
+        auto *const string_ty = get_type(ctx.llvm_context);
+        auto *const pieces = ctx.allocator.allocate(llvm::ArrayType::get(string_ty, strings.size()), "str.pieces");
+
+        for (auto const idx : helper::indices(strings.size())) {
+            ctx.builder.CreateStore(emit_value(strings[idx]), ctx.builder.CreateConstInBoundsGEP2_32(pieces, 0u, idx));
+        }
+
+        llvm::Value *result = owned ?
+            ctx.allocator.allocate_owner(string_ty, builtin_func_emitter.emit_string_release_func(string_ty), "str.concat.owner") :
+            nullptr;
+        if (!result) {
+            result = ctx.allocator.allocate(string_ty, "str.concat.result");
+            ctx.builder.CreateStore(llvm::Constant::getNullValue(string_ty), result);
+        }
+
+        ctx.builder.CreateCall3(
+                builtin_func_emitter.emit_string_concat_func(string_ty),
+                result,
+                ctx.builder.CreateConstInBoundsGEP2_32(pieces, 0u, 0u),
+                ctx.builder.getInt64(strings.size())
+            );
+
+        return ctx.builder.CreateLoad(result, "str.concat");
+    }
+
+    // Note:
+    // Strings are compared in lexicographical order of bytes
+    val emit_compare(val const lhs, val const rhs, std::string const& op)
+    {
+        if (op == "==" || op == "!=") {
+            auto *const equal = ctx.builder.CreateCall4(
+                    builtin_func_emitter.emit_string_equal_func(),
+                    emit_chars(lhs), emit_length(lhs),
+                    emit_chars(rhs), emit_length(rhs),
+                    "str.eq"
+                );
+            return op == "==" ? equal : ctx.builder.CreateNot(equal, "str.ne");
+        }
+
+        auto *const result = ctx.builder.CreateCall4(
+                builtin_func_emitter.emit_string_compare_func(),
+                emit_chars(lhs), emit_length(lhs),
+                emit_chars(rhs), emit_length(rhs),
+                "str.cmp"
+            );
+        auto *const zero = ctx.builder.getInt64(0u);
+
+        if (op == "<") {
+            return ctx.builder.CreateICmpSLT(result, zero);
+        } else if (op == ">") {
+            return ctx.builder.CreateICmpSGT(result, zero);
+        } else if (op == "<=") {
+            return ctx.builder.CreateICmpSLE(result, zero);
+        } else if (op == ">=") {
+            return ctx.builder.CreateICmpSGE(result, zero);
+        }
+
+        return nullptr;
+    }
+
+private:
+
+    val to_int64(val const v)
+    {
+        return v->getType()->isIntegerTy(64u) ? v : ctx.builder.CreateIntCast(v, ctx.builder.getInt64Ty(), true);
+    }
+};
+
+} // namespace llvmir
+} // namespace codegen
+} // namespace dachs
+
+#endif    // DACHS_CODEGEN_LLVMIR_STRING_IR_EMITTER_HPP_INCLUDED
@@ -0,0 +1,213 @@
+#if !defined DACHS_CODEGEN_LLVMIR_TAIL_CALL_OPTIMIZER_HPP_INCLUDED
+#define      DACHS_CODEGEN_LLVMIR_TAIL_CALL_OPTIMIZER_HPP_INCLUDED
+
+#include <vector>
+#include <unordered_set>
+#include <iterator>
+#include <cassert>
+
+#include <llvm/IR/Function.h>
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Constants.h>
+
+namespace dachs {
+namespace codegen {
+namespace llvmir {
+
+// Note:
+// Recursion is the idiomatic way to write a loop in Dachs.  Calls in tail position are
+// marked as 'tail' and self-recursive tail calls are replaced with a jump to the head of
+// the function.  This is done on emitting each function, so recursion doesn't consume
+// the stack regardless of the optimization level.
+class tail_call_optimizer {
+    llvm::Function &func;
+
+    // Note:
+    // A call is in tail position when only llvm.lifetime.end (emitted at the end of scopes)
+    // and unconditional branches are between the call and 'ret', and the returned value is
+    // the result of the call or unit.  Branches are followed because a call at the end of
+    // 'if' statement jumps to the end block of the statement before returning.
+    bool is_in_tail_position(llvm::CallInst *const call) const
+    {
+        auto itr = std::next(llvm::BasicBlock::iterator(call));
+        std::unordered_set<llvm::BasicBlock *> visited = {call->getParent()};
+
+        while (true) {
+            for (; !llvm::isa<llvm::TerminatorInst>(&*itr); ++itr) {
+                auto *const intrinsic = llvm::dyn_cast<llvm::IntrinsicInst>(&*itr);
+                if (!intrinsic || intrinsic->getIntrinsicID() != llvm::Intrinsic::lifetime_end) {
+                    return false;
+                }
+            }
+
+            auto *const br = llvm::dyn_cast<llvm::BranchInst>(&*itr);
+            if (!br || br->isConditional()) {
+                break;
+            }
+
+            auto *const next = br->getSuccessor(0u);
+            if (!visited.insert(next).second || llvm::isa<llvm::PHINode>(&*next->begin())) {
+                return false;
+            }
+            itr = next->begin();
+        }
+
+        auto *const ret = llvm::dyn_cast<llvm::ReturnInst>(&*itr);
+        if (!ret) {
+            return false;
+        }
+
+        auto *const ret_val = ret->getReturnValue();
+        if (!ret_val) {
+            return call->getType()->isVoidTy();
+        }
+
+        if (ret_val == call) {
+            return ret->getParent() == call->getParent();
+        }
+
+        auto *const unit_type = llvm::dyn_cast<llvm::StructType>(ret_val->getType());
+        return unit_type
+            && unit_type->getNumElements() == 0u
+            && call->getType() == unit_type;
+    }
+
+    // Note:
+    // Callee of tail call must not access the stack of the caller.  Pointers which may
+    // refer to allocas of this function (e.g. aggregates passed by reference) prevent it.
+    bool may_refer_to_stack(llvm::Value *v) const
+    {
+        if (!v->getType()->isPointerTy()) {
+            return false;
+        }
+
+        while (true) {
+            if (auto *const gep = llvm::dyn_cast<llvm::GetElementPtrInst>(v)) {
+                v = gep->getPointerOperand();
+            } else if (auto *const cast = llvm::dyn_cast<llvm::BitCastInst>(v)) {
+                v = cast->getOperand(0);
+            } else {
+                break;
+            }
+        }
+
+        return !llvm::isa<llvm::Argument>(v)
+            && !llvm::isa<llvm::Constant>(v)
+            && !llvm::isa<llvm::CallInst>(v);
+    }
+
+    bool is_tail_call_candidate(llvm::CallInst *const call) const
+    {
+        if (llvm::isa<llvm::IntrinsicInst>(call) || !is_in_tail_position(call)) {
+            return false;
+        }
+
+        for (unsigned i = 0u; i < call->getNumArgOperands(); ++i) {
+            if (may_refer_to_stack(call->getArgOperand(i))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /*
+     * - before
+     *   entry:
+     *     ; body
+     *     %r = call @f(%a1)
+     *     ret %r
+     *
+     * - after
+     *   entry:
+     *     ; allocas
+     *     br tailrecurse
+     *   tailrecurse:
+     *     %a = phi [%a0, entry], [%a1, ...]
+     *     ; body
+     *     br tailrecurse
+     */
+    void eliminate_self_recursion(std::vector<llvm::CallInst *> const& self_calls)
+    {
+        auto &old_entry = func.getEntryBlock();
+        auto *const new_entry = llvm::BasicBlock::Create(func.getContext(), "entry", &func, &old_entry);
+        old_entry.setName("tailrecurse");
+        auto *const br = llvm::BranchInst::Create(&old_entry, new_entry);
+
+        // Note:
+        // Stack slots are allocated once for all iterations
+        for (auto itr = old_entry.begin(); itr != old_entry.end();) {
+            auto *const alloca = llvm::dyn_cast<llvm::AllocaInst>(&*itr++);
+            if (alloca && llvm::isa<llvm::Constant>(alloca->getArraySize())) {
+                alloca->moveBefore(br);
+            }
+        }
+
+        std::vector<llvm::PHINode *> arg_phis;
+        for (auto &arg : func.getArgumentList()) {
+            auto *const phi = llvm::PHINode::Create(arg.getType(), self_calls.size() + 1u, arg.getName() + ".tr", old_entry.getFirstNonPHI());
+            arg.replaceAllUsesWith(phi);
+            phi->addIncoming(&arg, new_entry);
+            arg_phis.push_back(phi);
+        }
+
+        for (auto *const call : self_calls) {
+            auto *const block = call->getParent();
+            assert(call->getNumArgOperands() == arg_phis.size());
+
+            for (unsigned i = 0u; i < arg_phis.size(); ++i) {
+                arg_phis[i]->addIncoming(call->getArgOperand(i), block);
+            }
+
+            // Note:
+            // The terminator is 'ret' or a branch to the block which returns
+            auto *const terminator = block->getTerminator();
+            llvm::BranchInst::Create(&old_entry, terminator);
+            terminator->eraseFromParent();
+
+            assert(call->use_empty());
+            call->eraseFromParent();
+        }
+    }
+
+public:
+
+    explicit tail_call_optimizer(llvm::Function &f) noexcept
+        : func(f)
+    {}
+
+    void optimize()
+    {
+        std::vector<llvm::CallInst *> self_calls;
+
+        for (auto &block : func) {
+            for (auto &inst : block) {
+                auto *const call = llvm::dyn_cast<llvm::CallInst>(&inst);
+                if (!call || !is_tail_call_candidate(call)) {
+                    continue;
+                }
+
+                call->setTailCall();
+
+                // Note:
+                // The result of a function returning via sret is written through the pointer
+                // passed by the caller.  Keep the call for simplicity.
+                if (call->getCalledFunction() == &func && !func.hasStructRetAttr()) {
+                    self_calls.push_back(call);
+                }
+            }
+        }
+
+        if (!self_calls.empty()) {
+            eliminate_self_recursion(self_calls);
+        }
+    }
+};
+
+} // namespace llvmir
+} // namespace codegen
+} // namespace dachs
+
+#endif    // DACHS_CODEGEN_LLVMIR_TAIL_CALL_OPTIMIZER_HPP_INCLUDED
@@ -9,6 +9,7 @@
 #include <boost/range/irange.hpp>
 
 #include "dachs/codegen/llvmir/context.hpp"
+#include "dachs/codegen/llvmir/string_ir_emitter.hpp"
 #include "dachs/semantics/type.hpp"
 #include "dachs/helper/util.hpp"
 
@@ -18,6 +19,17 @@ namespace llvmir {
 
 using helper::indices;
 
+// Note:
+// Operators on SIMD vector types are applied element-wise.  LLVM instructions for
+// scalars also take vectors, so operators are selected by the element type.
+inline std::string element_name_of(type::builtin_type const& builtin) noexcept
+{
+    if (auto const simd = type::get_simd_vector_info(builtin)) {
+        return simd->element_type->name;
+    }
+    return builtin->name;
+}
+
 class tmp_builtin_unary_op_ir_emitter{
     context &ctx;
     llvm::Value *const value;
@@ -39,8 +51,9 @@ public:
 
     val emit(type::builtin_type const& builtin)
     {
-        bool const is_float = builtin->name == "float";
-        bool const is_int = builtin->name == "int" || builtin->name == "bool" || builtin->name == "char";
+        auto const name = element_name_of(builtin);
+        bool const is_float = name == "float";
+        bool const is_int = name == "int" || name == "bool" || name == "char";
 
         if (op == "+") {
             // Note: Do nothing.
@@ -106,9 +119,19 @@ public:
 
     val emit(type::builtin_type const& builtin) noexcept
     {
-        bool const is_float = builtin->name == "float";
-        bool const is_int = builtin->name == "int" || builtin->name == "bool" || builtin->name == "char";
-        bool const is_uint = builtin->name == "uint";
+        auto const name = element_name_of(builtin);
+        bool const is_float = name == "float";
+        bool const is_int = name == "int" || name == "bool" || name == "char";
+        bool const is_uint = name == "uint";
+
+        if (name == "string") {
+            if (op == "+") {
+                return string_ir_emitter{ctx}.emit_concat({lhs, rhs});
+            } else if (is_relational(op)) {
+                return string_ir_emitter{ctx}.emit_compare(lhs, rhs, op);
+            }
+            return nullptr;
+        }
 
         if (op == ">>") {
             return ctx.builder.CreateAShr(lhs, rhs, "shrtmp");
@@ -2,6 +2,7 @@
 #define      DACHS_CODEGEN_LLVMIR_TMP_CONSTRUCTOR_IR_EMITTER_HPP_INCLUDED
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
 #include <boost/variant/static_visitor.hpp>
@@ -13,6 +14,8 @@
 #include "dachs/semantics/type.hpp"
 #include "dachs/codegen/llvmir/context.hpp"
 #include "dachs/codegen/llvmir/type_ir_emitter.hpp"
+#include "dachs/codegen/llvmir/builtin_func_ir_emitter.hpp"
+#include "dachs/codegen/llvmir/dynamic_array_ir_emitter.hpp"
 #include "dachs/helper/util.hpp"
 
 namespace dachs {
@@ -23,24 +26,127 @@ namespace detail {
 class tmp_constructor_ir_emitter {
     using val = llvm::Value *;
 
+    // Note:
+    // Upper bound of the size of array elements allocated in the stack
+    static constexpr std::uint64_t max_stack_elems_size = 4096u;
+
     context &ctx;
     type_ir_emitter &type_emitter;
+    builtin_function_emitter &builtin_func_emitter;
 
     template<class Values>
     struct type_ctor_emitter : boost::static_visitor<val> {
         context &ctx;
         type_ir_emitter &type_emitter;
+        builtin_function_emitter &builtin_func_emitter;
         Values const& arg_values;
+        bool const frame_local;
+
+        type_ctor_emitter(context &c, type_ir_emitter &t, builtin_function_emitter &b, Values const& a, bool const l)
+            : ctx(c), type_emitter(t), builtin_func_emitter(b), arg_values(a), frame_local(l)
+        {}
 
-        type_ctor_emitter(context &c, type_ir_emitter &t, Values const& a)
-            : ctx(c), type_emitter(t), arg_values(a)
+        void emit_fill_loop(llvm::Value *const data, llvm::Value *const size, llvm::Value *const elem)
         {
-            assert(a.size() == 1 || a.size() == 2);
+            auto *const func = ctx.builder.GetInsertBlock()->getParent();
+            auto *const header_block = llvm::BasicBlock::Create(ctx.llvm_context, "ctor.header", func);
+            auto *const body_block = llvm::BasicBlock::Create(ctx.llvm_context, "ctor.body", func);
+            auto *const end_block = llvm::BasicBlock::Create(ctx.llvm_context, "ctor.end", func);
+
+            auto *const counter = ctx.allocator.allocate(ctx.builder.getInt64Ty(), "ctor.i");
+            ctx.builder.CreateStore(ctx.builder.getInt64(0u), counter);
+            ctx.builder.CreateBr(header_block);
+
+            ctx.builder.SetInsertPoint(header_block);
+            auto *const loaded_counter = ctx.builder.CreateLoad(counter);
+            ctx.builder.CreateCondBr(ctx.builder.CreateICmpULT(loaded_counter, size), body_block, end_block);
+
+            ctx.builder.SetInsertPoint(body_block);
+            ctx.builder.CreateStore(elem, ctx.builder.CreateInBoundsGEP(data, loaded_counter));
+            ctx.builder.CreateStore(ctx.builder.CreateNUWAdd(loaded_counter, ctx.builder.getInt64(1u)), counter);
+            ctx.builder.CreateBr(header_block);
+
+            ctx.builder.SetInsertPoint(end_block);
+        }
+
+        // Note:
+        // Elements of the array which never escapes from the frame (see escape_analyzer) don't need
+        // the runtime allocation.  They are allocated in the stack when the size is a small constant.
+        // The array can't be pushed because push() is considered as an escape.  Its header is
+        // also allocated in the stack (see dynamic_array_ir_emitter::emit_new()).
+        llvm::Value *emit_elems_on_stack(llvm::Type *const elem_ty, llvm::Value *const size)
+        {
+            auto *const constant_size = llvm::dyn_cast<llvm::ConstantInt>(size);
+            if (!frame_local || !constant_size) {
+                return nullptr;
+            }
+
+            auto const n = constant_size->getZExtValue();
+            if (n == 0u || n * ctx.data_layout->getTypeAllocSize(elem_ty) > max_stack_elems_size) {
+                return nullptr;
+            }
+
+            auto *const elems_ty = llvm::ArrayType::get(elem_ty, n);
+            auto *const allocated = ctx.allocator.allocate(elems_ty, "array.elems");
+
+            // Note:
+            // Elements are zero-cleared as the runtime allocation (calloc) does
+            ctx.builder.CreateMemSet(
+                    allocated,
+                    ctx.builder.getInt8(0u),
+                    ctx.data_layout->getTypeAllocSize(elems_ty),
+                    ctx.data_layout->getPrefTypeAlignment(elems_ty)
+                );
+
+            return ctx.builder.CreateConstInBoundsGEP2_32(allocated, 0u, 0u);
+        }
+
+        // Note:
+        // new [T]          -> empty array
+        // new [T]{n}       -> n zero-cleared elements
+        // new [T]{n, elem} -> n elements initialized with elem
+        val emit_dynamic_array(type::array_type const& a)
+        {
+            auto *const elem_ty = type_emitter.emit(a->element_type);
+            dynamic_array_ir_emitter array_emitter{ctx};
+
+            if (arg_values.empty()) {
+                return array_emitter.emit_new(
+                        llvm::ConstantPointerNull::get(elem_ty->getPointerTo()),
+                        ctx.builder.getInt64(0u),
+                        frame_local
+                    );
+            }
+
+            auto *const size = arg_values[0];
+            auto *data = emit_elems_on_stack(elem_ty, size);
+            if (!data) {
+                data = ctx.builder.CreateBitCast(
+                        ctx.builder.CreateCall2(
+                            builtin_func_emitter.emit_array_alloc_func(),
+                            ctx.builder.getInt64(ctx.data_layout->getTypeAllocSize(elem_ty)),
+                            size
+                        ),
+                        elem_ty->getPointerTo()
+                    );
+            }
+
+            if (arg_values.size() == 2) {
+                emit_fill_loop(data, size, arg_values[1]);
+            }
+
+            return array_emitter.emit_new(data, size, frame_local);
         }
 
         val operator()(type::array_type const& a)
         {
-            if (!llvm::isa<llvm::ConstantInt>(arg_values[0])) {
+            assert(arg_values.size() <= 2);
+
+            if (!a->size) {
+                return emit_dynamic_array(a);
+            }
+
+            if (arg_values.empty() || !llvm::isa<llvm::ConstantInt>(arg_values[0])) {
                 return nullptr;
             }
 
@@ -62,7 +168,7 @@ class tmp_constructor_ir_emitter {
                 return llvm::ConstantArray::get(ty, elems);
 
             } else {
-                auto *const allocated = ctx.builder.CreateAlloca(ty);
+                auto *const allocated = ctx.allocator.allocate(ty);
 
                 if (arg_values.size() == 1) {
                     ctx.builder.CreateMemSet(
@@ -84,6 +190,69 @@ class tmp_constructor_ir_emitter {
             }
         }
 
+        // Note:
+        // new {K => V} -> empty dictionary
+        val operator()(type::dict_type const& d)
+        {
+            if (!arg_values.empty()) {
+                return nullptr;
+            }
+
+            auto const key_builtin = type::get<type::builtin_type>(d->key_type);
+            if (!key_builtin) {
+                return nullptr;
+            }
+
+            // Note:
+            // Key kind of runtime hash table.  0 is compared by bytes, 1 is compared as C string
+            // (symbol) and 2 is compared as { characters, length } (string).
+            auto const& key_name = (*key_builtin)->name;
+            auto const key_kind = key_name == "string" ? 2u : key_name == "symbol" ? 1u : 0u;
+
+            auto *const entry_ty = type_emitter.emit_dict_entry(d);
+            return ctx.builder.CreateCall4(
+                    builtin_func_emitter.emit_dict_new_func(),
+                    ctx.builder.getInt64(ctx.data_layout->getTypeAllocSize(entry_ty)),
+                    ctx.builder.getInt64(ctx.data_layout->getTypeStoreSize(entry_ty->getElementType(0u))),
+                    ctx.builder.getInt64(ctx.data_layout->getStructLayout(entry_ty)->getElementOffset(1u)),
+                    ctx.builder.getInt64(key_kind)
+                );
+        }
+
+        // Note:
+        // new float4{x}          -> x in all lanes
+        // new float4{a, b, c, d} -> each lane
+        val operator()(type::builtin_type const& b)
+        {
+            auto const simd = type::get_simd_vector_info(b);
+            if (!simd) {
+                return nullptr;
+            }
+
+            auto *const ty = type_emitter.emit(b);
+            auto *const undef = llvm::UndefValue::get(ty);
+
+            if (arg_values.size() == 1u) {
+                auto *const first = ctx.builder.CreateInsertElement(undef, arg_values[0], ctx.builder.getInt32(0u));
+                return ctx.builder.CreateShuffleVector(
+                        first,
+                        undef,
+                        llvm::ConstantAggregateZero::get(llvm::VectorType::get(ctx.builder.getInt32Ty(), simd->lanes)),
+                        "splat"
+                    );
+            }
+
+            if (arg_values.size() != simd->lanes) {
+                return nullptr;
+            }
+
+            llvm::Value *result = undef;
+            for (auto const idx : helper::indices(simd->lanes)) {
+                result = ctx.builder.CreateInsertElement(result, arg_values[idx], ctx.builder.getInt32(idx));
+            }
+            return result;
+        }
+
         template<class T>
         val operator()(T const&)
         {
@@ -93,14 +262,20 @@ class tmp_constructor_ir_emitter {
 
 public:
 
-    tmp_constructor_ir_emitter(context &c, type_ir_emitter &t) noexcept
-        : ctx(c), type_emitter(t)
+    tmp_constructor_ir_emitter(context &c, type_ir_emitter &t, builtin_function_emitter &b) noexcept
+        : ctx(c), type_emitter(t), builtin_func_emitter(b)
     {}
 
+    val emit_empty_dict(type::dict_type const& d)
+    {
+        std::vector<val> const no_args;
+        return type_ctor_emitter<std::vector<val>>{ctx, type_emitter, builtin_func_emitter, no_args, false}(d);
+    }
+
     template<class Values>
-    val emit(type::type &type, Values const& arg_values)
+    val emit(type::type &type, Values const& arg_values, bool const frame_local = false)
     {
-        return type.apply_visitor(type_ctor_emitter<Values>{ctx, type_emitter, arg_values});
+        return type.apply_visitor(type_ctor_emitter<Values>{ctx, type_emitter, builtin_func_emitter, arg_values, frame_local});
     }
 };
 
@@ -11,6 +11,8 @@
 
 #include "dachs/semantics/type.hpp"
 #include "dachs/codegen/llvmir/context.hpp"
+#include "dachs/codegen/llvmir/string_ir_emitter.hpp"
+#include "dachs/codegen/llvmir/dynamic_array_ir_emitter.hpp"
 
 namespace dachs {
 namespace codegen {
@@ -61,17 +63,35 @@ class tmp_member_ir_emitter {
                 if (t->size) {
                     return ctx.builder.getInt64(*t->size);
                 } else {
-                    auto *ty = value->getType();
-                    if (ty->isPointerTy()) {
-                        ty = ty->getPointerElementType();
-                    }
+                    return dynamic_array_ir_emitter{ctx}.emit_size(value);
+                }
+            }
 
-                    if (!llvm::isa<llvm::ArrayType>(ty)) {
-                        return nullptr;
-                    }
+            return nullptr;
+        }
 
-                    return ctx.builder.getInt64(ty->getArrayNumElements());
-                }
+        val operator()(type::dict_type const&)
+        {
+            if (name != "size") {
+                return nullptr;
+            }
+
+            auto *handle = value;
+            if (handle->getType()->getPointerElementType()->isPointerTy()) {
+                handle = ctx.builder.CreateLoad(handle);
+            }
+
+            // Note:
+            // The number of entries is the first member of the hash table (see runtime/dict.cpp)
+            return ctx.builder.CreateLoad(
+                    ctx.builder.CreateBitCast(handle, ctx.builder.getInt64Ty()->getPointerTo())
+                );
+        }
+
+        val operator()(type::builtin_type const& t)
+        {
+            if (t->name == "string" && name == "size") {
+                return string_ir_emitter{ctx}.emit_length(value);
             }
 
             return nullptr;
@@ -93,7 +113,7 @@ public:
     val emit_var(val const child_value, std::string const& member_name, type::type &&child_type)
     {
         if (member_name == "__type") {
-            return ctx.builder.CreateGlobalStringPtr(child_type.to_string().c_str());
+            return string_ir_emitter{ctx}.emit_constant(child_type.to_string());
         }
 
         return child_type.apply_visitor(type_visit_emitter{member_name, child_value, ctx});
@@ -2,6 +2,10 @@
 #define      DACHS_CODEGEN_LLVMIR_TYPE_IR_GENERATOR_HPP_INCLUDED
 
 #include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <type_traits>
 #include <cassert>
 
 #include <llvm/IR/LLVMContext.h>
@@ -21,7 +25,14 @@ namespace llvmir {
 
 class type_ir_emitter {
     llvm::LLVMContext &context;
-    semantics::lambda_captures_type lambda_captures;
+    semantics::lambda_captures_type const& lambda_captures;
+
+    // Note:
+    // Lowered types are memoized by the identity of type nodes.  Type nodes are shared
+    // among AST nodes and symbols after semantic analysis, so the same node is lowered
+    // many times.  The node is kept alive in the cache so that its address is never
+    // reused by another node while emitting.
+    std::unordered_map<void const*, std::pair<std::shared_ptr<void const>, llvm::Type *>> lowered;
 
     template<class String>
     void error(String const& msg)
@@ -38,6 +49,22 @@ class type_ir_emitter {
         return v;
     }
 
+    template<class TypeNode, class Lower>
+    auto memoize(std::shared_ptr<TypeNode> const& t, Lower const& lower)
+        -> decltype(lower())
+    {
+        using result_type = typename std::remove_pointer<decltype(lower())>::type;
+
+        auto const itr = lowered.find(t.get());
+        if (itr != std::end(lowered)) {
+            return llvm::cast<result_type>(itr->second.second);
+        }
+
+        auto *const result = lower();
+        lowered.emplace(t.get(), std::make_pair(std::shared_ptr<void const>{t}, result));
+        return result;
+    }
+
 public:
 
     type_ir_emitter(llvm::LLVMContext &c, decltype(lambda_captures) const& lc)
@@ -52,10 +79,17 @@ public:
     }
 
     llvm::Type *emit(type::builtin_type const& builtin)
+    {
+        return memoize(builtin, [&, this]{ return emit_builtin(builtin); });
+    }
+
+    llvm::Type *emit_builtin(type::builtin_type const& builtin)
     {
         llvm::Type *result = nullptr;
 
-        if (builtin->name == "int") {
+        if (auto const simd = type::get_simd_vector_info(builtin)) {
+            result = llvm::VectorType::get(emit(simd->element_type), simd->lanes);
+        } else if (builtin->name == "int") {
             result = llvm::Type::getInt64Ty(context);
         } else if (builtin->name == "uint") {
             result = llvm::Type::getInt64Ty(context);
@@ -66,7 +100,8 @@ public:
         } else if (builtin->name == "bool") {
             result = llvm::Type::getInt1Ty(context);
         } else if (builtin->name == "string") {
-            result = llvm::Type::getInt8PtrTy(context);
+            // Note: { characters, length } (see string_ir_emitter)
+            result = llvm::StructType::get(context, {llvm::Type::getInt8PtrTy(context), llvm::Type::getInt64Ty(context)});
         } else if (builtin->name == "symbol") {
             result = llvm::Type::getInt8PtrTy(context);
         } else {
@@ -87,30 +122,37 @@ public:
 
     llvm::Type *emit(type::tuple_type const& t)
     {
-        std::vector<llvm::Type *> element_type_irs;
-        element_type_irs.reserve(t->element_types.size());
-        for (auto const& t : t->element_types) {
-            element_type_irs.push_back(emit(t));
-        }
-
-        return check(
-            llvm::StructType::get(context, element_type_irs)
-            , "tuple type"
-        );
+        return memoize(t, [&, this]
+            {
+                std::vector<llvm::Type *> element_type_irs;
+                element_type_irs.reserve(t->element_types.size());
+                for (auto const& t : t->element_types) {
+                    element_type_irs.push_back(emit(t));
+                }
+
+                return check(
+                    llvm::StructType::get(context, element_type_irs)
+                    , "tuple type"
+                );
+            });
     }
 
     llvm::ArrayType *emit_fixed_array(type::array_type const& a)
     {
         assert(a->size);
-        return llvm::ArrayType::get(emit(a->element_type), *a->size);
+        return memoize(a, [&, this]{ return llvm::ArrayType::get(emit(a->element_type), *a->size); });
     }
 
+    // Note:
+    // Dynamically sized array is a handle of the header allocated by the runtime
+    // (see dynamic_array_ir_emitter and runtime/array.cpp).  Copies of an array refer
+    // to the same header.
     llvm::Type *emit(type::array_type const& a)
     {
         if (a->size) {
             return emit_fixed_array(a);
         } else {
-            throw not_implemented_error{__FILE__, __func__, __LINE__, "variable array type LLVM IR generation"};
+            return llvm::Type::getInt8PtrTy(context);
         }
     }
 
@@ -125,6 +167,13 @@ public:
     }
 
     llvm::StructType *emit(type::generic_func_type const& g)
+    {
+        return memoize(g, [&, this]{ return emit_lambda_captures(g); });
+    }
+
+    // Note:
+    // Captures are referred from the semantics context.  They are not copied.
+    llvm::StructType *emit_lambda_captures(type::generic_func_type const& g)
     {
         if (!g->ref || g->ref->expired()) {
             return llvm::StructType::get(context, {});
@@ -139,21 +188,38 @@ public:
         auto const& captures = itr->second;
         std::vector<llvm::Type *> capture_types;
         capture_types.reserve(captures.size());
-        for (auto const& capture : captures.get<semantics::tags::offset>()) {
+        for (auto const& capture : captures) {
             capture_types.push_back(emit(capture.introduced->type));
         }
 
         return llvm::StructType::get(context, capture_types);
     }
 
+    // Note:
+    // Dictionary is a handle of the hash table allocated by the runtime (see runtime/dict.cpp).
+    // Copies of a dictionary refer to the same table.
     llvm::Type *emit(type::dict_type const&)
     {
-        throw not_implemented_error{__FILE__, __func__, __LINE__, "dictionary type LLVM IR generation"};
+        return llvm::Type::getInt8PtrTy(context);
+    }
+
+    // Note:
+    // Layout of an entry in the hash table.  Keys and values are stored inline.
+    llvm::StructType *emit_dict_entry(type::dict_type const& d)
+    {
+        return llvm::StructType::get(context, {emit(d->key_type), emit(d->value_type)});
     }
 
-    llvm::Type *emit(type::range_type const&)
+    // Note:
+    // Range is { first, last, step }.  Whether 'last' is included or not is
+    // known from the type and not stored in the value.
+    llvm::Type *emit(type::range_type const& r)
     {
-        throw not_implemented_error{__FILE__, __func__, __LINE__, "range type LLVM IR generation"};
+        return memoize(r, [&, this]
+            {
+                auto *const elem_type = emit(r->element_type);
+                return llvm::StructType::get(context, {elem_type, elem_type, elem_type});
+            });
     }
 
     llvm::Type *emit(type::qualified_type const&)
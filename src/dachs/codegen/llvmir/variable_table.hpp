@@ -128,6 +128,13 @@ public:
 
         if (auto const maybe_allocated_aggregate = detail::lookup_table(alloca_aggregate_table, sym)) {
             auto const& allocated_aggregate = *maybe_allocated_aggregate;
+
+            // Note:
+            // A first-class aggregate value (e.g. a returned tuple) is stored directly
+            if (!detail::is_aggregate_ptr(v->getType())) {
+                return ctx.builder.CreateStore(v, allocated_aggregate);
+            }
+
             auto *const t = allocated_aggregate->getAllocatedType();
             ctx.builder.CreateMemCpy(
                     allocated_aggregate,
@@ -201,6 +208,15 @@ public:
         return erase_register_value(s) || erase_alloca_value(s);
     }
 
+    // Note:
+    // An outlined function (e.g. the body of parallel for) has its own table
+    void swap(variable_table &other) noexcept
+    {
+        register_table.swap(other.register_table);
+        alloca_table.swap(other.alloca_table);
+        alloca_aggregate_table.swap(other.alloca_aggregate_table);
+    }
+
     bool insert(symbol::var_symbol const& key, val const value) noexcept
     {
         assert(!detail::exists_in_table(alloca_table, key));
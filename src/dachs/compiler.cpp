@@ -30,7 +30,7 @@ std::string compiler::read(std::string const& file) const
 std::string compiler::compile(compiler::files_type const& files, std::vector<std::string> const& libdirs, bool const colorful, bool const debug) const
 {
     std::vector<llvm::Module *> modules;
-    codegen::llvmir::context context;
+    codegen::llvmir::context context{target};
 
     for (auto const& f : files) {
         auto const code = read(f);
@@ -43,7 +43,7 @@ std::string compiler::compile(compiler::files_type const& files, std::vector<std
             std::cerr << ast::stringize_ast(ast, colorful) << "\n\n";
         }
 
-        auto ctx = semantics::analyze_semantics(ast);
+        auto ctx = semantics::analyze_semantics(ast, only_reachable);
         if (debug) {
             std::cerr << "=========Scope Tree=========\n\n"
                       <<  scope::stringize_scope_tree(ctx.scopes) << "\n\n";
@@ -65,12 +65,12 @@ std::string compiler::compile(compiler::files_type const& files, std::vector<std
 std::vector<std::string> compiler::compile_to_objects(compiler::files_type const& files, bool const colorful, bool const debug) const
 {
     std::vector<llvm::Module *> modules;
-    codegen::llvmir::context context;
+    codegen::llvmir::context context{target};
 
     for (auto const& f : files) {
         auto const code = read(f);
         auto ast = parser.parse(code, f);
-        auto semantics = semantics::analyze_semantics(ast);
+        auto semantics = semantics::analyze_semantics(ast, only_reachable);
         auto &module = codegen::llvmir::emit_llvm_ir(ast, semantics, context);
         if (debug) {
             std::cerr << "file: " << f << '\n'
@@ -94,19 +94,19 @@ std::string compiler::report_ast(std::string const& file, std::string const& cod
 std::string compiler::report_scope_tree(std::string const& file, std::string const& code) const
 {
     auto ast = parser.parse(code, file);
-    auto ctx = semantics::analyze_semantics(ast);
+    auto ctx = semantics::analyze_semantics(ast, only_reachable);
     return scope::stringize_scope_tree(ctx.scopes);
 }
 
 std::string compiler::report_llvm_ir(std::string const& file, std::string const& code) const
 {
     auto ast = parser.parse(code, file);
-    auto ctx = semantics::analyze_semantics(ast);
+    auto ctx = semantics::analyze_semantics(ast, only_reachable);
 
     std::string result;
     llvm::raw_string_ostream raw_os{result};
 
-    codegen::llvmir::context context;
+    codegen::llvmir::context context{target};
     codegen::llvmir::emit_llvm_ir(ast, ctx, context).print(raw_os, nullptr);
     return result;
 }
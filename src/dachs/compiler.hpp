@@ -7,11 +7,14 @@
 #include "dachs/ast/ast_fwd.hpp"
 #include "dachs/parser/parser.hpp"
 #include "dachs/semantics/scope.hpp"
+#include "dachs/codegen/llvmir/context.hpp"
 
 namespace dachs {
 
 class compiler final {
     syntax::parser parser;
+    bool const only_reachable;
+    codegen::llvmir::target_spec const target;
 
     using files_type = std::vector<std::string>;
 
@@ -19,6 +22,10 @@ class compiler final {
 
 public:
 
+    explicit compiler(bool const only_reachable = false, codegen::llvmir::target_spec const& target = {})
+        : only_reachable(only_reachable), target(target)
+    {}
+
     std::string compile(files_type const& files, files_type const& libdirs, bool const colorful = true, bool const debug = false) const;
     std::vector<std::string> compile_to_objects(files_type const& files, bool const colorful = true, bool const debug = false) const;
 
@@ -851,24 +851,37 @@ public:
                 _val = make_node_ptr<ast::node::switch_stmt>(_1, _2, _3)
             ];
 
+        // Note:
+        // '@vectorize', '@vectorize(4)', '@unroll(8)' and so on.
+        loop_hint
+            = (
+                qi::lexeme['@' >> +(qi::alnum | qi::char_('_'))]
+                >> -('(' >> qi::uint_ >> ')')
+            );
+
+        loop_hints
+            = *(loop_hint >> -sep);
+
         for_stmt
             = (
                 // Note: "do" might colide with do-end block in typed_expr
-                DACHS_KWD("for") >> (parameter - DACHS_KWD("in")) % comma >> DACHS_KWD("in") >> typed_expr >> sep
+                loop_hints
+                >> DACHS_KWD("for") >> (parameter - DACHS_KWD("in")) % comma >> DACHS_KWD("in") >> typed_expr >> sep
                 >> stmt_block_before_end >> -sep
                 >> "end"
             ) [
-                _val = make_node_ptr<ast::node::for_stmt>(_1, _2, _3)
+                _val = make_node_ptr<ast::node::for_stmt>(_2, _3, _4, _1)
             ];
 
         while_stmt
             = (
                 // Note: "do" might colide with do-end block in typed_expr
-                DACHS_KWD("for") >> typed_expr >> (DACHS_KWD("do") || sep)
+                loop_hints
+                >> DACHS_KWD("for") >> typed_expr >> (DACHS_KWD("do") || sep)
                 >> stmt_block_before_end >> -sep
                 >> "end"
             ) [
-                _val = make_node_ptr<ast::node::while_stmt>(_1, _2)
+                _val = make_node_ptr<ast::node::while_stmt>(_2, _3, _1)
             ];
 
         postfix_if_return_stmt
@@ -1116,6 +1129,8 @@ public:
         return_stmt.name("return statement");
         case_stmt.name("case statement");
         switch_stmt.name("switch statement");
+        loop_hint.name("loop hint");
+        loop_hints.name("loop hints");
         for_stmt.name("for statement");
         while_stmt.name("while statement");
         variable_decl.name("variable declaration");
@@ -1189,6 +1204,8 @@ private:
     rule<ast::node::initialize_stmt()> constant_definition;
     rule<ast::node::function_definition()> do_block, lambda_expr_oneline, lambda_expr_do_end;
     rule<ast::node::statement_block()> do_stmt;
+    rule<ast::node_type::loop_hint()> loop_hint;
+    rule<ast::node_type::loop_hints()> loop_hints;
 
     rule<ast::node::any_expr()>
           primary_literal
@@ -0,0 +1,82 @@
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+
+// Note: Output buffered by print() and println() is written before aborting
+extern "C" void __dachs_flush__();
+
+// Note:
+// Header of dynamically sized array.  It must be the same as the LLVM IR type
+// emitted by dynamic_array_ir_emitter::get_header_type(): { i8*, i64, i64 }
+// An array value is a pointer to the header and copies of the array share it.
+// So reallocated elements never leave a dangling pointer in another copy.
+struct dachs_array {
+    void *data;
+    std::uint64_t size;
+    std::uint64_t capacity;
+};
+
+namespace {
+
+[[noreturn]] void fail_to_allocate()
+{
+    __dachs_flush__();
+    std::fputs("Failed to allocate memory for array\n", stderr);
+    std::abort();
+}
+
+dachs_array *new_array(void *const data, std::uint64_t const size)
+{
+    auto *const a = static_cast<dachs_array *>(std::malloc(sizeof(dachs_array)));
+    if (!a) {
+        fail_to_allocate();
+    }
+
+    a->data = data;
+    a->size = size;
+    a->capacity = size;
+    return a;
+}
+
+} // namespace
+
+extern "C" {
+    void *__dachs_array_alloc__(std::uint64_t const elem_size, std::uint64_t const n)
+    {
+        if (n == 0u) {
+            return nullptr;
+        }
+
+        auto *const allocated = std::calloc(n, elem_size);
+        if (!allocated) {
+            fail_to_allocate();
+        }
+        return allocated;
+    }
+
+    void *__dachs_array_new__(void *const data, std::uint64_t const size)
+    {
+        return new_array(data, size);
+    }
+
+    // Note:
+    // Capacity is doubled to make push amortized O(1).  A zero-initialized array
+    // (e.g. an element of 'new [[int]]{n}') has no header yet.  It is allocated here.
+    void __dachs_array_grow__(void **const array, std::uint64_t const elem_size)
+    {
+        if (!*array) {
+            *array = new_array(nullptr, 0u);
+        }
+
+        auto *const a = static_cast<dachs_array *>(*array);
+        auto const new_capacity = a->capacity == 0u ? 4u : a->capacity * 2u;
+
+        auto *const reallocated = std::realloc(a->data, new_capacity * elem_size);
+        if (!reallocated) {
+            fail_to_allocate();
+        }
+
+        a->data = reallocated;
+        a->capacity = new_capacity;
+    }
+}
@@ -0,0 +1,206 @@
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+// Note: Output buffered by print() and println() is written before aborting
+extern "C" void __dachs_flush__();
+
+// Note: Implemented in string.cpp
+extern "C" bool __dachs_string_equal__(char const*, std::uint64_t, char const*, std::uint64_t);
+extern "C" std::uint64_t __dachs_string_hash__(char const*, std::uint64_t);
+
+// Note:
+// Open addressing hash table with linear probing.
+// Keys and values are stored inline in one contiguous entry array.  The layout of
+// an entry ({ key, value }) is decided by the code generator per dictionary type and
+// the runtime only knows its size and the offset of the value.
+// States of slots are separated from entries to make probing cache-friendly.
+
+namespace {
+
+enum key_kind : std::uint64_t {
+    bitwise = 0u,  // Compared and hashed by the bytes of key
+    c_string = 1u, // Key is char const* and compared and hashed by the content (symbol)
+    string = 2u,   // Key is { char const*, uint64_t } and compared and hashed by the content
+};
+
+struct string_key {
+    char const* ptr;
+    std::uint64_t len;
+};
+
+enum slot_state : std::uint8_t {
+    empty = 0u,
+    occupied = 1u,
+};
+
+struct dachs_dict {
+    std::uint64_t size; // Note: Must be the first member.  Code generator loads it directly.
+    std::uint64_t capacity;
+    std::uint64_t entry_size;
+    std::uint64_t key_size;
+    std::uint64_t value_offset;
+    std::uint64_t kind;
+    std::uint8_t *states;
+    std::uint8_t *entries;
+};
+
+void *allocate(std::uint64_t const n, std::uint64_t const size)
+{
+    auto *const allocated = std::calloc(n, size);
+    if (!allocated) {
+        __dachs_flush__();
+        std::fputs("Failed to allocate memory for dictionary\n", stderr);
+        std::abort();
+    }
+    return allocated;
+}
+
+std::uint64_t hash_bytes(std::uint8_t const* const bytes, std::uint64_t const size)
+{
+    // FNV-1a
+    std::uint64_t h = 14695981039346656037ull;
+    for (std::uint64_t i = 0u; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::uint64_t hash_key(dachs_dict const* const d, void const* const key)
+{
+    if (d->kind == c_string) {
+        auto const* const s = *static_cast<char const* const*>(key);
+        return hash_bytes(reinterpret_cast<std::uint8_t const*>(s), std::strlen(s));
+    } else if (d->kind == string) {
+        auto const* const s = static_cast<string_key const*>(key);
+        return __dachs_string_hash__(s->ptr, s->len);
+    }
+
+    auto h = hash_bytes(static_cast<std::uint8_t const*>(key), d->key_size);
+    // Note: Mix bits because capacity is a power of 2 and only lower bits are used
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+bool equal_keys(dachs_dict const* const d, void const* const lhs, void const* const rhs)
+{
+    if (d->kind == c_string) {
+        return std::strcmp(*static_cast<char const* const*>(lhs), *static_cast<char const* const*>(rhs)) == 0;
+    } else if (d->kind == string) {
+        auto const* const l = static_cast<string_key const*>(lhs);
+        auto const* const r = static_cast<string_key const*>(rhs);
+        return __dachs_string_equal__(l->ptr, l->len, r->ptr, r->len);
+    }
+    return std::memcmp(lhs, rhs, d->key_size) == 0;
+}
+
+std::uint8_t *entry_at(dachs_dict const* const d, std::uint64_t const idx)
+{
+    return d->entries + idx * d->entry_size;
+}
+
+// Note:
+// Return the index of the slot which has the key or the empty slot where the key should be inserted
+std::uint64_t probe(dachs_dict const* const d, void const* const key)
+{
+    auto const mask = d->capacity - 1u;
+    for (auto idx = hash_key(d, key) & mask; ; idx = (idx + 1u) & mask) {
+        if (d->states[idx] == empty || equal_keys(d, entry_at(d, idx), key)) {
+            return idx;
+        }
+    }
+}
+
+void rehash(dachs_dict *const d, std::uint64_t const new_capacity)
+{
+    auto *const old_states = d->states;
+    auto *const old_entries = d->entries;
+    auto const old_capacity = d->capacity;
+
+    d->capacity = new_capacity;
+    d->states = static_cast<std::uint8_t *>(allocate(new_capacity, 1u));
+    d->entries = static_cast<std::uint8_t *>(allocate(new_capacity, d->entry_size));
+
+    for (std::uint64_t i = 0u; i < old_capacity; ++i) {
+        if (old_states[i] != occupied) {
+            continue;
+        }
+        auto *const old_entry = old_entries + i * d->entry_size;
+        auto const idx = probe(d, old_entry);
+        d->states[idx] = occupied;
+        std::memcpy(entry_at(d, idx), old_entry, d->entry_size);
+    }
+
+    std::free(old_states);
+    std::free(old_entries);
+}
+
+} // namespace
+
+extern "C" {
+    void *__dachs_dict_new__(std::uint64_t const entry_size, std::uint64_t const key_size, std::uint64_t const value_offset, std::uint64_t const kind)
+    {
+        auto *const d = static_cast<dachs_dict *>(allocate(1u, sizeof(dachs_dict)));
+        d->size = 0u;
+        d->capacity = 8u;
+        d->entry_size = entry_size;
+        d->key_size = key_size;
+        d->value_offset = value_offset;
+        d->kind = kind;
+        d->states = static_cast<std::uint8_t *>(allocate(d->capacity, 1u));
+        d->entries = static_cast<std::uint8_t *>(allocate(d->capacity, entry_size));
+        return d;
+    }
+
+    // Note:
+    // Return the pointer to the value of the key.  When the key is not found,
+    // a zero-cleared value is inserted.
+    void *__dachs_dict_insert__(void *const dict, void const* const key)
+    {
+        auto *const d = static_cast<dachs_dict *>(dict);
+
+        // Note: Keep load factor under 3/4
+        if ((d->size + 1u) * 4u > d->capacity * 3u) {
+            rehash(d, d->capacity * 2u);
+        }
+
+        auto const idx = probe(d, key);
+        auto *const entry = entry_at(d, idx);
+        if (d->states[idx] == empty) {
+            d->states[idx] = occupied;
+            std::memcpy(entry, key, d->key_size);
+            ++d->size;
+        }
+
+        return entry + d->value_offset;
+    }
+
+    void *__dachs_dict_at__(void *const dict, void const* const key)
+    {
+        auto *const d = static_cast<dachs_dict *>(dict);
+        auto const idx = probe(d, key);
+        if (d->states[idx] == empty) {
+            __dachs_flush__();
+            std::fputs("Key is not found in dictionary\n", stderr);
+            std::abort();
+        }
+        return entry_at(d, idx) + d->value_offset;
+    }
+
+    std::uint64_t __dachs_dict_capacity__(void *const dict)
+    {
+        return static_cast<dachs_dict *>(dict)->capacity;
+    }
+
+    // Note:
+    // Return the entry at the slot or null if the slot is empty.  This is used for iteration.
+    void *__dachs_dict_entry_at__(void *const dict, std::uint64_t const idx)
+    {
+        auto *const d = static_cast<dachs_dict *>(dict);
+        return d->states[idx] == occupied ? entry_at(d, idx) : nullptr;
+    }
+}
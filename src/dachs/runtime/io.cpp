@@ -1,75 +1,673 @@
-#include <string>
-#include <cstdio>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+
+// Note:
+// Output of print() and println() is appended to a buffer for each thread instead of calling
+// printf() for each value.  Values are formatted by hand, so no format string is parsed and
+// no locale is consulted.  The buffer is flushed when it is full, at exit of the thread
+// (including exit of the program) and by __dachs_flush__().  When stdout is a terminal, it is
+// also flushed at the end of each line.
+
+namespace {
+
+bool const stdout_is_tty = ::isatty(STDOUT_FILENO) == 1;
+
+void write_all(char const* p, std::size_t n)
+{
+    while (n > 0u) {
+        auto const written = ::write(STDOUT_FILENO, p, n);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        p += written;
+        n -= static_cast<std::size_t>(written);
+    }
+}
+
+class output_buffer {
+    static std::size_t const capacity = 64u * 1024u;
+    char data[capacity];
+    std::size_t size = 0u;
+
+public:
+
+    // Note: Enough for any formatted number
+    static std::size_t const max_formatted_size = 32u;
+
+    ~output_buffer()
+    {
+        flush();
+    }
+
+    void flush()
+    {
+        write_all(data, size);
+        size = 0u;
+    }
+
+    void append(char const* const s, std::size_t const n)
+    {
+        if (capacity - size < n) {
+            flush();
+            if (n >= capacity) {
+                write_all(s, n);
+                return;
+            }
+        }
+        std::memcpy(data + size, s, n);
+        size += n;
+    }
+
+    void append(char const c)
+    {
+        if (size == capacity) {
+            flush();
+        }
+        data[size++] = c;
+    }
+
+    // Note:
+    // Formatters write directly into the buffer.  reserve() returns the position to write
+    // at most max_formatted_size characters and commit() takes the end of written characters.
+    char *reserve()
+    {
+        if (capacity - size < max_formatted_size) {
+            flush();
+        }
+        return data + size;
+    }
+
+    void commit(char const* const end)
+    {
+        size = static_cast<std::size_t>(end - data);
+    }
+};
+
+thread_local output_buffer buffer;
+
+void end_line()
+{
+    buffer.append('\n');
+    if (stdout_is_tty) {
+        buffer.flush();
+    }
+}
+
+char const digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+char *format_uint(std::uint64_t u, char *out)
+{
+    char tmp[20];
+    auto *p = tmp + sizeof(tmp);
+
+    while (u >= 100u) {
+        auto const pair = static_cast<std::size_t>(u % 100u) * 2u;
+        u /= 100u;
+        *--p = digit_pairs[pair + 1u];
+        *--p = digit_pairs[pair];
+    }
+
+    if (u >= 10u) {
+        auto const pair = static_cast<std::size_t>(u) * 2u;
+        *--p = digit_pairs[pair + 1u];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = static_cast<char>('0' + u);
+    }
+
+    auto const len = static_cast<std::size_t>(tmp + sizeof(tmp) - p);
+    std::memcpy(out, p, len);
+    return out + len;
+}
+
+char *format_int(std::int64_t const i, char *out)
+{
+    if (i < 0) {
+        *out++ = '-';
+        return format_uint(0u - static_cast<std::uint64_t>(i), out);
+    }
+    return format_uint(static_cast<std::uint64_t>(i), out);
+}
+
+// Note:
+// Unsigned integer with fixed capacity to generate digits of double exactly.
+// The largest value appears when formatting the smallest subnormal number (about 2^1140).
+class big_uint {
+    static std::size_t const max_limbs = 40u;
+    std::uint32_t limbs[max_limbs];
+    std::size_t size = 0u;
+
+    void trim()
+    {
+        while (size > 0u && limbs[size - 1u] == 0u) {
+            --size;
+        }
+    }
+
+public:
+
+    explicit big_uint(std::uint64_t u)
+    {
+        while (u != 0u) {
+            limbs[size++] = static_cast<std::uint32_t>(u);
+            u >>= 32;
+        }
+    }
+
+    void shift_left(unsigned int const n)
+    {
+        if (size == 0u) {
+            return;
+        }
+
+        auto const bits = n % 32u;
+        if (bits != 0u) {
+            std::uint32_t carry = 0u;
+            for (std::size_t i = 0u; i < size; ++i) {
+                auto const shifted = (static_cast<std::uint64_t>(limbs[i]) << bits) | carry;
+                limbs[i] = static_cast<std::uint32_t>(shifted);
+                carry = static_cast<std::uint32_t>(shifted >> 32);
+            }
+            if (carry != 0u) {
+                limbs[size++] = carry;
+            }
+        }
+
+        auto const words = n / 32u;
+        if (words != 0u) {
+            std::memmove(limbs + words, limbs, size * sizeof(std::uint32_t));
+            std::memset(limbs, 0, words * sizeof(std::uint32_t));
+            size += words;
+        }
+    }
+
+    void multiply(std::uint32_t const m)
+    {
+        std::uint32_t carry = 0u;
+        for (std::size_t i = 0u; i < size; ++i) {
+            auto const product = static_cast<std::uint64_t>(limbs[i]) * m + carry;
+            limbs[i] = static_cast<std::uint32_t>(product);
+            carry = static_cast<std::uint32_t>(product >> 32);
+        }
+        if (carry != 0u) {
+            limbs[size++] = carry;
+        }
+    }
+
+    void multiply_pow10(unsigned int n)
+    {
+        for (; n >= 9u; n -= 9u) {
+            multiply(1000000000u);
+        }
+
+        std::uint32_t m = 1u;
+        for (; n > 0u; --n) {
+            m *= 10u;
+        }
+        multiply(m);
+    }
+
+    void add(big_uint const& rhs)
+    {
+        std::uint64_t carry = 0u;
+        auto const n = size > rhs.size ? size : rhs.size;
+        for (std::size_t i = 0u; i < n; ++i) {
+            auto const sum = carry
+                + (i < size ? limbs[i] : 0u)
+                + (i < rhs.size ? rhs.limbs[i] : 0u);
+            limbs[i] = static_cast<std::uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        size = n;
+        if (carry != 0u) {
+            limbs[size++] = static_cast<std::uint32_t>(carry);
+        }
+    }
+
+    // Note: *this must not be less than rhs
+    void subtract(big_uint const& rhs)
+    {
+        std::int64_t borrow = 0;
+        for (std::size_t i = 0u; i < size; ++i) {
+            auto diff = static_cast<std::int64_t>(limbs[i]) - borrow - (i < rhs.size ? rhs.limbs[i] : 0);
+            borrow = 0;
+            if (diff < 0) {
+                diff += std::int64_t{1} << 32;
+                borrow = 1;
+            }
+            limbs[i] = static_cast<std::uint32_t>(diff);
+        }
+        trim();
+    }
+
+    friend int compare(big_uint const& lhs, big_uint const& rhs)
+    {
+        if (lhs.size != rhs.size) {
+            return lhs.size < rhs.size ? -1 : 1;
+        }
+
+        for (auto i = lhs.size; i > 0u; --i) {
+            if (lhs.limbs[i - 1u] != rhs.limbs[i - 1u]) {
+                return lhs.limbs[i - 1u] < rhs.limbs[i - 1u] ? -1 : 1;
+            }
+        }
+
+        return 0;
+    }
+};
+
+// Note:
+// The same interface as big_uint.  Values of most doubles in practice (roughly from 1e-17
+// to 1e35) are formatted within 128 bits without touching memory.
+class wide_uint {
+    unsigned __int128 value;
+
+public:
+
+    explicit wide_uint(std::uint64_t const u) noexcept
+        : value(u)
+    {}
+
+    void shift_left(unsigned int const n) noexcept
+    {
+        value <<= n;
+    }
+
+    void multiply(std::uint32_t const m) noexcept
+    {
+        value *= m;
+    }
+
+    void multiply_pow10(unsigned int n) noexcept
+    {
+        for (; n > 0u; --n) {
+            value *= 10u;
+        }
+    }
+
+    void add(wide_uint const& rhs) noexcept
+    {
+        value += rhs.value;
+    }
+
+    void subtract(wide_uint const& rhs) noexcept
+    {
+        value -= rhs.value;
+    }
+
+    friend int compare(wide_uint const& lhs, wide_uint const& rhs) noexcept
+    {
+        return lhs.value < rhs.value ? -1 : lhs.value == rhs.value ? 0 : 1;
+    }
+};
+
+template<class UInt>
+int compare_sum(UInt lhs, UInt const& addend, UInt const& rhs)
+{
+    lhs.add(addend);
+    return compare(lhs, rhs);
+}
+
+// Note: Quotient must be less than 10.  r becomes the remainder.
+template<class UInt>
+unsigned int divide(UInt &r, UInt const& divisor)
+{
+    unsigned int quotient = 0u;
+    while (compare(r, divisor) >= 0) {
+        r.subtract(divisor);
+        ++quotient;
+    }
+    return quotient;
+}
+
+struct decomposed_double {
+    std::uint64_t f;
+    int e; // Note: The value is f * 2^e
+    bool even;
+    bool unequal_gaps;
+    int k; // Note: Estimate of ceil(log10(value))
+};
+
+// Note:
+// Free-format algorithm of Burger and Dybvig ("Printing Floating-Point Numbers Quickly and
+// Accurately", 1996).  The value is scaled to r/s and the half gaps to its neighbors to
+// m_plus/s and m_minus/s.  Digits are generated until the rest falls in the gaps.
+template<class UInt>
+std::size_t generate_digits(decomposed_double const& v, char *const digits, int &exponent)
+{
+    UInt r{v.f}, s{1u}, m_plus{1u}, m_minus{1u};
+    if (v.e >= 0) {
+        auto const shift = static_cast<unsigned int>(v.e);
+        m_plus.shift_left(v.unequal_gaps ? shift + 1u : shift);
+        m_minus.shift_left(shift);
+        r.shift_left(v.unequal_gaps ? shift + 2u : shift + 1u);
+        s.shift_left(v.unequal_gaps ? 2u : 1u);
+    } else {
+        auto const shift = static_cast<unsigned int>(-v.e);
+        if (v.unequal_gaps) {
+            m_plus.shift_left(1u);
+        }
+        r.shift_left(v.unequal_gaps ? 2u : 1u);
+        s.shift_left(v.unequal_gaps ? shift + 2u : shift + 1u);
+    }
+
+    auto k = v.k;
+    if (k >= 0) {
+        s.multiply_pow10(static_cast<unsigned int>(k));
+    } else {
+        auto const n = static_cast<unsigned int>(-k);
+        r.multiply_pow10(n);
+        m_plus.multiply_pow10(n);
+        m_minus.multiply_pow10(n);
+    }
+
+    auto const even = v.even;
+    auto const reaches_upper
+        = [even](UInt const& r, UInt const& m_plus, UInt const& s)
+        {
+            auto const c = compare_sum(r, m_plus, s);
+            return even ? c >= 0 : c > 0;
+        };
+
+    // Note: The estimate of k was smaller than the actual one by 1
+    if (reaches_upper(r, m_plus, s)) {
+        ++k;
+    } else {
+        r.multiply(10u);
+        m_plus.multiply(10u);
+        m_minus.multiply(10u);
+    }
+    exponent = k;
+
+    std::size_t n = 0u;
+    while (true) {
+        auto const d = divide(r, s);
+        auto const c = compare(r, m_minus);
+        bool const low = even ? c <= 0 : c < 0;
+        bool const high = reaches_upper(r, m_plus, s);
+
+        if (!low && !high) {
+            digits[n++] = static_cast<char>('0' + d);
+            r.multiply(10u);
+            m_plus.multiply(10u);
+            m_minus.multiply(10u);
+            continue;
+        }
+
+        if (low && high) {
+            auto twice = r;
+            twice.shift_left(1u);
+            digits[n++] = static_cast<char>('0' + (compare(twice, s) < 0 ? d : d + 1u));
+        } else {
+            digits[n++] = static_cast<char>('0' + (low ? d : d + 1u));
+        }
+        return n;
+    }
+}
+
+// Note:
+// Generates the shortest digits which are read back to the same finite positive double.
+// The value is 0.d1d2d3... * 10^exponent.  Returns the number of digits.
+std::size_t shortest_digits(std::uint64_t const bits, char *const digits, int &exponent)
+{
+    auto const biased_exponent = static_cast<int>((bits >> 52) & 0x7ffu);
+    auto const fraction = bits & ((std::uint64_t{1} << 52) - 1u);
+
+    decomposed_double v;
+    v.f = biased_exponent == 0 ? fraction : fraction | (std::uint64_t{1} << 52);
+    v.e = (biased_exponent == 0 ? 1 : biased_exponent) - 1075;
+    v.even = (v.f & 1u) == 0u;
+
+    // Note:
+    // The gap to the lower neighbor is the half of the gap to the upper neighbor
+    // when the value is a power of 2 (except for the smallest normal number).
+    v.unequal_gaps = fraction == 0u && biased_exponent > 1;
+
+    // Note:
+    // Estimate from the position of the highest bit.  It may be smaller than the actual
+    // one by 1, which is fixed up on generating digits.
+    auto highest_bit = 0;
+    for (auto t = v.f; t != 0u; t >>= 1) {
+        ++highest_bit;
+    }
+    auto const estimate = (v.e + highest_bit - 1) * 0.30102999566398114 - 1e-10;
+    v.k = static_cast<int>(estimate);
+    if (v.k < estimate) {
+        ++v.k;
+    }
+
+    // Note:
+    // All values in generate_digits() are less than 16 * s.  Bits of s are counted
+    // roughly (log2(10) < 10/3).
+    auto const s_bits = (v.e >= 0 ? 2 : 2 - v.e) + (v.k > 0 ? v.k * 10 / 3 + 1 : 0);
+    return s_bits <= 120 ?
+        generate_digits<wide_uint>(v, digits, exponent) :
+        generate_digits<big_uint>(v, digits, exponent);
+}
+
+// Note:
+// Notation follows '%g' of printf() (e.g. '1', '0.25', '1e+20', '1.5e-07') but with the
+// shortest digits to read back the same value instead of 6 significant digits.
+char *format_float(double const d, char *out)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+
+    if ((bits >> 63) != 0u) {
+        *out++ = '-';
+        bits &= ~(std::uint64_t{1} << 63);
+    }
+
+    if ((bits >> 52) == 0x7ffu) {
+        auto const special = (bits & ((std::uint64_t{1} << 52) - 1u)) == 0u ? "inf" : "nan";
+        std::memcpy(out, special, 3u);
+        return out + 3;
+    }
+
+    if (bits == 0u) {
+        *out++ = '0';
+        return out;
+    }
+
+    double magnitude;
+    std::memcpy(&magnitude, &bits, sizeof(magnitude));
+
+    // Note: Fast path for integral values which are exactly representable
+    if (magnitude < 9007199254740992.0 && magnitude == static_cast<double>(static_cast<std::uint64_t>(magnitude))) {
+        return format_uint(static_cast<std::uint64_t>(magnitude), out);
+    }
+
+    char digits[17];
+    int k;
+    auto const n = static_cast<int>(shortest_digits(bits, digits, k));
+    auto const exponent = k - 1;
+
+    if (exponent < -4 || exponent >= 16) {
+        *out++ = digits[0];
+        if (n > 1) {
+            *out++ = '.';
+            std::memcpy(out, digits + 1, static_cast<std::size_t>(n - 1));
+            out += n - 1;
+        }
+
+        *out++ = 'e';
+        *out++ = exponent < 0 ? '-' : '+';
+        auto const abs_exponent = static_cast<unsigned int>(exponent < 0 ? -exponent : exponent);
+        if (abs_exponent < 10u) {
+            *out++ = '0';
+        }
+        return format_uint(abs_exponent, out);
+    }
+
+    if (k <= 0) {
+        *out++ = '0';
+        *out++ = '.';
+        for (auto i = k; i < 0; ++i) {
+            *out++ = '0';
+        }
+        std::memcpy(out, digits, static_cast<std::size_t>(n));
+        return out + n;
+    }
+
+    if (k >= n) {
+        std::memcpy(out, digits, static_cast<std::size_t>(n));
+        out += n;
+        for (auto i = n; i < k; ++i) {
+            *out++ = '0';
+        }
+        return out;
+    }
+
+    std::memcpy(out, digits, static_cast<std::size_t>(k));
+    out += k;
+    *out++ = '.';
+    std::memcpy(out, digits + k, static_cast<std::size_t>(n - k));
+    return out + (n - k);
+}
+
+template<class Formatter, class T>
+void append_formatted(Formatter const format, T const value)
+{
+    buffer.commit(format(value, buffer.reserve()));
+}
+
+void append_string(char const* const s, std::size_t const len)
+{
+    if (len == 0u) {
+        return;
+    }
+
+    buffer.append(s, len);
+    if (stdout_is_tty && std::memchr(s, '\n', len)) {
+        buffer.flush();
+    }
+}
+
+void append_char(char const c)
+{
+    if (c == '\n') {
+        end_line();
+    } else {
+        buffer.append(c);
+    }
+}
+
+void append_bool(bool const b)
+{
+    if (b) {
+        buffer.append("true", 4u);
+    } else {
+        buffer.append("false", 5u);
+    }
+}
+
+} // namespace
 
 extern "C" {
+    void __dachs_flush__()
+    {
+        buffer.flush();
+    }
+
     void __dachs_println_float__(double const d)
     {
-        std::printf("%lg\n", d);
+        append_formatted(format_float, d);
+        end_line();
     }
 
     void __dachs_println_int__(std::int64_t const i)
     {
-        std::printf("%lld\n", i);
+        append_formatted(format_int, i);
+        end_line();
     }
 
     void __dachs_println_uint__(std::uint64_t const u)
     {
-        std::printf("%llu\n", u);
+        append_formatted(format_uint, u);
+        end_line();
     }
 
     void __dachs_println_char__(char const c)
     {
-        std::printf("%c\n", c);
+        append_char(c);
+        end_line();
     }
 
-    void __dachs_println_string__(char const* const s)
+    void __dachs_println_string__(char const* const s, std::uint64_t const len)
     {
-        std::printf("%s\n", s);
+        append_string(s, static_cast<std::size_t>(len));
+        end_line();
     }
 
     void __dachs_println_symbol__(char const* const s)
     {
-        std::printf("%s\n", s);
+        append_string(s, std::strlen(s));
+        end_line();
     }
 
     void __dachs_println_bool__(bool const b)
     {
-        std::printf("%s\n", b ? "true" : "false");
+        append_bool(b);
+        end_line();
     }
 
     void __dachs_print_float__(double const d)
     {
-        std::printf("%lg", d);
+        append_formatted(format_float, d);
     }
 
     void __dachs_print_int__(std::int64_t const i)
     {
-        std::printf("%lld", i);
+        append_formatted(format_int, i);
     }
 
     void __dachs_print_uint__(std::uint64_t const u)
     {
-        std::printf("%llu", u);
+        append_formatted(format_uint, u);
     }
 
     void __dachs_print_char__(char const c)
     {
-        std::printf("%c", c);
+        append_char(c);
     }
 
-    void __dachs_print_string__(char const* const s)
+    void __dachs_print_string__(char const* const s, std::uint64_t const len)
     {
-        std::printf("%s", s);
+        append_string(s, static_cast<std::size_t>(len));
     }
 
     void __dachs_print_symbol__(char const* const s)
     {
-        std::printf("%s", s);
+        append_string(s, std::strlen(s));
     }
 
     void __dachs_print_bool__(bool const b)
     {
-        std::printf("%s", b ? "true" : "false");
+        append_bool(b);
+    }
+
+    // Note:
+    // Writes 'd' in the notation of print() to 'out', which has room for 32 characters, and
+    // returns the number of written characters
+    std::uint64_t __dachs_format_float__(double const d, char *const out)
+    {
+        return static_cast<std::uint64_t>(format_float(d, out) - out);
     }
 }
@@ -0,0 +1,249 @@
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Note:
+// Runtime of parallel for.  The code generator outlines the body of the loop into a function
+// which iterates indices in [begin, end).
+//
+// The index space is divided into contiguous ranges, one for each worker.  A worker takes
+// small chunks from the front of its own range.  When its range becomes empty, it steals the
+// latter half of the range of another worker.  So the load is balanced even if iterations
+// have different costs, and each worker mostly accesses contiguous elements.
+// The calling thread works as the worker 0.
+
+extern "C" void __dachs_flush__();
+
+namespace {
+
+using body_type = void (*)(void *, std::uint64_t, std::uint64_t);
+
+struct job {
+    body_type body;
+    void *env;
+    std::uint64_t grain;
+};
+
+struct work_range {
+    std::mutex mutex;
+    std::uint64_t begin = 0u;
+    std::uint64_t end = 0u;
+    char padding[64]; // Note: Avoid false sharing between ranges of workers
+};
+
+// Note:
+// Nested parallel for (e.g. a function called in the body has parallel for) runs sequentially
+thread_local bool in_worker = false;
+
+unsigned int num_threads()
+{
+    if (auto const* const env = std::getenv("DACHS_NUM_THREADS")) {
+        auto const n = std::strtoul(env, nullptr, 10);
+        if (n > 0u) {
+            return static_cast<unsigned int>(n);
+        }
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+class thread_pool {
+    unsigned int const num_workers;
+    std::unique_ptr<work_range[]> ranges;
+    std::vector<std::thread> threads;
+
+    std::mutex dispatch_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    job const* current = nullptr;
+    std::uint64_t generation = 0u;
+    unsigned int busy = 0u;
+    bool stopping = false;
+
+    bool take(unsigned int const id, std::uint64_t const grain, std::uint64_t &begin, std::uint64_t &end)
+    {
+        auto &own = ranges[id];
+        std::lock_guard<std::mutex> lock{own.mutex};
+        if (own.begin >= own.end) {
+            return false;
+        }
+
+        begin = own.begin;
+        end = own.end - own.begin > grain ? own.begin + grain : own.end;
+        own.begin = end;
+        return true;
+    }
+
+    bool steal(unsigned int const id)
+    {
+        for (unsigned int i = 1u; i < num_workers; ++i) {
+            auto &victim = ranges[(id + i) % num_workers];
+            std::uint64_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock{victim.mutex};
+                if (victim.begin >= victim.end) {
+                    continue;
+                }
+                begin = victim.begin + (victim.end - victim.begin) / 2u;
+                end = victim.end;
+                victim.end = begin;
+            }
+
+            auto &own = ranges[id];
+            std::lock_guard<std::mutex> lock{own.mutex};
+            own.begin = begin;
+            own.end = end;
+            return true;
+        }
+
+        return false;
+    }
+
+    // Note:
+    // Ranges only shrink except the one refilled by its owner's steal.  So when a worker
+    // finds no range to steal, all remaining chunks are owned by other busy workers.
+    void work(unsigned int const id, job const& j)
+    {
+        std::uint64_t begin, end;
+        do {
+            while (take(id, j.grain, begin, end)) {
+                j.body(j.env, begin, end);
+            }
+        } while (steal(id));
+    }
+
+    void run_worker(unsigned int const id)
+    {
+        in_worker = true;
+        std::uint64_t seen = 0u;
+
+        while (true) {
+            job const* j = nullptr;
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                wake.wait(lock, [&]{ return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+
+                seen = generation;
+                j = current;
+                if (!j) {
+                    // Note: The job was already finished by other workers
+                    continue;
+                }
+                ++busy;
+            }
+
+            work(id, *j);
+
+            // Note: Output in the body is written before the loop finishes
+            __dachs_flush__();
+
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                --busy;
+            }
+            done.notify_one();
+        }
+    }
+
+    void distribute(std::uint64_t const n)
+    {
+        auto const quotient = n / num_workers;
+        auto const remainder = n % num_workers;
+        std::uint64_t begin = 0u;
+
+        for (unsigned int i = 0u; i < num_workers; ++i) {
+            auto const size = quotient + (i < remainder ? 1u : 0u);
+            std::lock_guard<std::mutex> lock{ranges[i].mutex};
+            ranges[i].begin = begin;
+            ranges[i].end = begin + size;
+            begin += size;
+        }
+    }
+
+public:
+
+    explicit thread_pool(unsigned int const n)
+        : num_workers(n), ranges(new work_range[n])
+    {
+        for (unsigned int i = 1u; i < num_workers; ++i) {
+            threads.emplace_back([this, i]{ run_worker(i); });
+        }
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    bool run(body_type const body, void *const env, std::uint64_t const n)
+    {
+        std::unique_lock<std::mutex> dispatch_lock{dispatch_mutex, std::try_to_lock};
+        if (!dispatch_lock.owns_lock() || num_workers == 1u || n < 2u) {
+            return false;
+        }
+
+        // Note:
+        // Chunks are small enough to balance the load and large enough to amortize locking
+        job const j{body, env, std::max<std::uint64_t>(1u, n / (num_workers * 16u))};
+        distribute(n);
+
+        // Note: Output before the loop is written before any output of the workers
+        __dachs_flush__();
+
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            current = &j;
+            ++generation;
+        }
+        wake.notify_all();
+
+        in_worker = true;
+        work(0u, j);
+        in_worker = false;
+
+        // Note: Output of the chunks run by the caller is written as well as the workers' output
+        __dachs_flush__();
+
+        std::unique_lock<std::mutex> lock{mutex};
+        done.wait(lock, [this]{ return busy == 0u; });
+        current = nullptr;
+        return true;
+    }
+};
+
+} // namespace
+
+extern "C" {
+    void __dachs_parallel_for__(body_type const body, void *const env, std::uint64_t const n)
+    {
+        if (n == 0u) {
+            return;
+        }
+
+        if (!in_worker) {
+            static thread_pool pool{num_threads()};
+            if (pool.run(body, env, n)) {
+                return;
+            }
+        }
+
+        body(env, 0u, n);
+    }
+}
@@ -0,0 +1,238 @@
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// Note: Output buffered by print() and println() is written before aborting
+extern "C" void __dachs_flush__();
+
+// Note:
+// Layout of string.  It must be the same as the LLVM IR type emitted by
+// type_ir_emitter::emit() for 'string': { i8*, i64 }
+// Characters are not terminated by '\0'.  Strings are immutable and a slice shares
+// the characters of its source string.  So no function here writes to the characters
+// of a given string.
+struct dachs_string {
+    char const* ptr;
+    std::uint64_t len;
+};
+
+namespace {
+
+// Note:
+// Characters built by concatenation are preceded by the header of their buffer.  A buffer is
+// referred by the string builder which appends to it and by the result slots of concatenations
+// (see string_ir_emitter::emit_concat()).  It is freed when the last reference is released.
+// A slice of a concatenated string doesn't refer to the buffer.  The compiler releases a result
+// slot only when the result can't be referred after that.
+struct buffer_header {
+    std::uint64_t refcount;
+};
+
+inline buffer_header *header_of(char const* const chars) noexcept
+{
+    return reinterpret_cast<buffer_header *>(const_cast<char *>(chars)) - 1;
+}
+
+inline void retain(char const* const chars) noexcept
+{
+    if (chars) {
+        ++header_of(chars)->refcount;
+    }
+}
+
+inline void release(char const* const chars) noexcept
+{
+    if (!chars) {
+        return;
+    }
+
+    auto *const header = header_of(chars);
+    if (--header->refcount == 0u) {
+        std::free(header);
+    }
+}
+
+// Note:
+// String builder for concatenation.  A concatenated string is written to the buffer of
+// a builder.  When the first operand of concatenation is the whole content of a buffer
+// (e.g. 's' in 's += t' in a loop), following operands are appended to the buffer in place.
+// It doesn't break other strings because no string refers to the bytes after the end of
+// the content.  Capacity is doubled to make appending amortized O(n).
+struct string_builder {
+    char *data = nullptr;
+    std::uint64_t size = 0u;
+    std::uint64_t capacity = 0u;
+    std::uint64_t last_used = 0u;
+
+    string_builder() = default;
+    string_builder(string_builder const&) = delete;
+    string_builder &operator=(string_builder const&) = delete;
+
+    ~string_builder()
+    {
+        release(data);
+    }
+
+    bool owns(dachs_string const& s) const noexcept
+    {
+        return data && s.ptr == data && s.len == size;
+    }
+
+    // Note:
+    // Returns the previous buffer.  The caller must release it after copying the operands
+    // because they may refer to it.
+    char *start(std::uint64_t const min_capacity)
+    {
+        auto const new_capacity = min_capacity < 8u ? 16u : min_capacity * 2u;
+
+        auto *const header = static_cast<buffer_header *>(std::malloc(sizeof(buffer_header) + new_capacity));
+        if (!header) {
+            __dachs_flush__();
+            std::fputs("Failed to allocate memory for string\n", stderr);
+            std::abort();
+        }
+        header->refcount = 1u;
+
+        auto *const previous = data;
+        data = reinterpret_cast<char *>(header + 1);
+        size = 0u;
+        capacity = new_capacity;
+        return previous;
+    }
+
+    void append(dachs_string const& s)
+    {
+        if (s.len == 0u) {
+            return;
+        }
+        std::memcpy(data + size, s.ptr, s.len);
+        size += s.len;
+    }
+};
+
+// Note:
+// A few builders are kept for each thread so that a concatenation of temporaries
+// (e.g. 't' in 't = a + b; s += t') doesn't take the buffer of 's'.  A new result is
+// built by the least recently used builder.
+std::size_t const num_builders = 4u;
+thread_local string_builder builders[num_builders];
+thread_local std::uint64_t builder_clock = 0u;
+
+string_builder &builder_for(dachs_string const& first, std::uint64_t const len, char *&retired)
+{
+    auto *lru = &builders[0];
+    for (auto &b : builders) {
+        if (b.owns(first)) {
+            if (b.capacity - b.size < len - first.len) {
+                retired = b.start(len);
+            }
+            b.last_used = ++builder_clock;
+            return b;
+        }
+
+        if (b.last_used < lru->last_used) {
+            lru = &b;
+        }
+    }
+
+    retired = lru->start(len);
+    lru->last_used = ++builder_clock;
+    return *lru;
+}
+
+inline std::uint64_t rotate(std::uint64_t const x, unsigned int const n) noexcept
+{
+    return (x << n) | (x >> (64u - n));
+}
+
+} // namespace
+
+extern "C" {
+    // Note:
+    // 'a + b + c' is lowered to one call with all operands.  So the result is allocated once.
+    // The result is written to 'result' rather than returned because the way to return
+    // a struct by value depends on the C ABI and the emitted IR doesn't follow it.
+    // 'result' is the slot which owns the result.  It must be null or hold the previous
+    // result, which is released.
+    void __dachs_string_concat__(dachs_string *const result, dachs_string const* const pieces, std::uint64_t const n)
+    {
+        std::uint64_t len = 0u;
+        for (std::uint64_t i = 0u; i < n; ++i) {
+            len += pieces[i].len;
+        }
+
+        if (len == 0u) {
+            release(result->ptr);
+            *result = {nullptr, 0u};
+            return;
+        }
+
+        char *retired = nullptr;
+        auto &builder = builder_for(pieces[0], len, retired);
+        for (std::uint64_t i = builder.owns(pieces[0]) ? 1u : 0u; i < n; ++i) {
+            builder.append(pieces[i]);
+        }
+
+        // Note:
+        // The previous result may be the buffer of the new one (e.g. 's += t')
+        retain(builder.data);
+        release(result->ptr);
+        release(retired);
+        *result = {builder.data, len};
+    }
+
+    void __dachs_string_release__(dachs_string *const s)
+    {
+        release(s->ptr);
+        *s = {nullptr, 0u};
+    }
+
+    // Note:
+    // Returns negative, zero or positive value in lexicographical order
+    std::int64_t __dachs_string_compare__(char const* const lhs, std::uint64_t const lhs_len, char const* const rhs, std::uint64_t const rhs_len)
+    {
+        auto const len = lhs_len < rhs_len ? lhs_len : rhs_len;
+        if (len != 0u) {
+            if (auto const result = std::memcmp(lhs, rhs, len)) {
+                return result;
+            }
+        }
+
+        return lhs_len == rhs_len ? 0 : lhs_len < rhs_len ? -1 : 1;
+    }
+
+    bool __dachs_string_equal__(char const* const lhs, std::uint64_t const lhs_len, char const* const rhs, std::uint64_t const rhs_len)
+    {
+        return lhs_len == rhs_len && (lhs_len == 0u || lhs == rhs || std::memcmp(lhs, rhs, lhs_len) == 0);
+    }
+
+    // Note:
+    // Characters are hashed by 8 bytes.  The result is finally mixed because hash tables
+    // use only the lower bits of it.
+    std::uint64_t __dachs_string_hash__(char const* const s, std::uint64_t const len)
+    {
+        std::uint64_t h = len * 0x9e3779b97f4a7c15ull;
+        std::uint64_t i = 0u;
+
+        for (; i + 8u <= len; i += 8u) {
+            std::uint64_t word;
+            std::memcpy(&word, s + i, 8u);
+            h = rotate((h ^ word) * 0x9e3779b97f4a7c15ull, 29u);
+        }
+
+        if (i < len) {
+            std::uint64_t word = 0u;
+            std::memcpy(&word, s + i, static_cast<std::size_t>(len - i));
+            h = rotate((h ^ word) * 0x9e3779b97f4a7c15ull, 29u);
+        }
+
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 33;
+        return h;
+    }
+}
@@ -5,12 +5,14 @@
 #include <unordered_set>
 #include <tuple>
 #include <set>
+#include <algorithm>
 
 #include <boost/variant/apply_visitor.hpp>
 #include <boost/variant/static_visitor.hpp>
 #include <boost/algorithm/cxx11/all_of.hpp>
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/range/algorithm/transform.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 
@@ -30,6 +32,7 @@
 #include "dachs/semantics/tmp_member_checker.hpp"
 #include "dachs/semantics/tmp_constructor_checker.hpp"
 #include "dachs/fatal.hpp"
+#include "dachs/statistics.hpp"
 #include "dachs/helper/variant.hpp"
 #include "dachs/helper/util.hpp"
 #include "dachs/helper/each.hpp"
@@ -148,6 +151,189 @@ struct var_ref_getter_for_lhs_of_assign {
     }
 };
 
+struct local_symbols_collector {
+    std::unordered_set<symbol::var_symbol> locals;
+
+    template<class W>
+    void visit(ast::node::variable_decl const& decl, W const& w)
+    {
+        if (!decl->symbol.expired()) {
+            locals.insert(decl->symbol.lock());
+        }
+        w();
+    }
+
+    template<class W>
+    void visit(ast::node::parameter const& param, W const& w)
+    {
+        if (!param->param_symbol.expired()) {
+            locals.insert(param->param_symbol.lock());
+        }
+        w();
+    }
+
+    template<class N, class W>
+    void visit(N const&, W const& w)
+    {
+        w();
+    }
+};
+
+bool modifies_outer_state(scope::func_scope const& callee, std::unordered_set<scope::func_scope> &visited);
+
+// Note:
+// Iterations of '@parallel' for statement run concurrently.  Its body may read any variable
+// and write elements of arrays (each iteration should write its own elements).  It must not
+// modify other state declared outside of the body because the modification races.
+// Callees are checked in the same way against variables declared in their bodies.  Their
+// parameters share elements with the caller's containers, so a callee which pushes to an array
+// or inserts into a dictionary given as an argument is rejected.  Reassigning a parameter
+// itself only modifies the copy.  Note that a local copy of a parameter is not tracked.
+template<class Reporter>
+class parallel_body_checker {
+    std::unordered_set<symbol::var_symbol> const& locals;
+    Reporter const& report;
+    std::unordered_set<scope::func_scope> &visited;
+    bool const in_callee;
+
+    template<class Expr>
+    boost::optional<ast::node::var_ref> outer_var_of(Expr const& e) const
+    {
+        auto const ref = var_ref_getter_for_lhs_of_assign{}.visit(e);
+        if (!ref || ref->symbol.expired() || locals.find(ref->symbol.lock()) != std::end(locals)) {
+            return boost::none;
+        }
+        return ref;
+    }
+
+    template<class Node, class Expr>
+    void check_push(Node const& node, Expr const& array)
+    {
+        if (auto const ref = outer_var_of(array)) {
+            report(node, boost::format("push() to '%1%' can't be in the body of parallel for because '%1%' is declared outside of it") % (*ref)->name);
+        }
+    }
+
+    template<class Scope>
+    static bool is_push(Scope const& callee_scope)
+    {
+        return !callee_scope.expired()
+            && callee_scope.lock()->is_builtin
+            && callee_scope.lock()->name == "push";
+    }
+
+    template<class Node, class Scope>
+    void check_callee(Node const& node, Scope const& callee_scope)
+    {
+        if (callee_scope.expired()) {
+            return;
+        }
+
+        auto const callee = callee_scope.lock();
+        if (modifies_outer_state(callee, visited)) {
+            report(node, boost::format("'%1%' can't be called in the body of parallel for because it may modify variables declared outside of it") % callee->name);
+        }
+    }
+
+public:
+
+    parallel_body_checker(
+            std::unordered_set<symbol::var_symbol> const& l,
+            Reporter const& r,
+            std::unordered_set<scope::func_scope> &v,
+            bool const c = false) noexcept
+        : locals(l), report(r), visited(v), in_callee(c)
+    {}
+
+    template<class W>
+    void visit(ast::node::return_stmt const& ret, W const& w)
+    {
+        if (!in_callee) {
+            report(ret, "'return' can't be in the body of parallel for");
+        }
+        w();
+    }
+
+    template<class W>
+    void visit(ast::node::assignment_stmt const& assign, W const& w)
+    {
+        for (auto const& lhs : assign->assignees) {
+            auto const access = get_as<ast::node::index_access>(lhs);
+            if (access && type::is_a<type::array_type>(type::type_of((*access)->child))) {
+                continue;
+            }
+
+            if (in_callee && get_as<ast::node::var_ref>(lhs)) {
+                continue;
+            }
+
+            if (auto const ref = outer_var_of(lhs)) {
+                report(assign, boost::format("'%1%' can't be modified in the body of parallel for because it is declared outside of it") % (*ref)->name);
+            }
+        }
+        w();
+    }
+
+    template<class W>
+    void visit(ast::node::func_invocation const& invocation, W const& w)
+    {
+        if (is_push(invocation->callee_scope)) {
+            if (!invocation->args.empty()) {
+                check_push(invocation, invocation->args[0]);
+            }
+        } else {
+            check_callee(invocation, invocation->callee_scope);
+        }
+        w();
+    }
+
+    template<class W>
+    void visit(ast::node::ufcs_invocation const& ufcs, W const& w)
+    {
+        if (is_push(ufcs->callee_scope)) {
+            check_push(ufcs, ufcs->child);
+        } else {
+            check_callee(ufcs, ufcs->callee_scope);
+        }
+        w();
+    }
+
+    template<class N, class W>
+    void visit(N const&, W const& w)
+    {
+        w();
+    }
+};
+
+// Note:
+// Each function is visited at most once while checking one parallel for.  A function which
+// is being visited is assumed not to modify outer state, but its modification is still found
+// by the visit in progress and propagated to the invocation in the body.
+bool modifies_outer_state(scope::func_scope const& callee, std::unordered_set<scope::func_scope> &visited)
+{
+    if (callee->is_builtin || !visited.insert(callee).second) {
+        return false;
+    }
+
+    auto const def = callee->get_ast_node();
+
+    local_symbols_collector collector;
+    ast::walk_topdown(def->body, collector);
+    if (def->ensure_body) {
+        ast::walk_topdown(*def->ensure_body, collector);
+    }
+
+    bool modifies = false;
+    auto const reporter = [&modifies](auto const&, auto const&){ modifies = true; };
+    parallel_body_checker<decltype(reporter)> checker{collector.locals, reporter, visited, true};
+    ast::walk_topdown(def->body, checker);
+    if (def->ensure_body) {
+        ast::walk_topdown(*def->ensure_body, checker);
+    }
+
+    return modifies;
+}
+
 // Walk to resolve symbol references
 class symbol_analyzer {
 
@@ -158,6 +344,7 @@ class symbol_analyzer {
     lambda_captures_type captures;
     std::unordered_map<type::generic_func_type, ast::node::tuple_literal> lambda_instantiation_map;
     std::unordered_set<ast::node::function_definition> already_visited_functions;
+    bool const only_reachable = false;
 
     // Introduce a new scope and ensure to restore the old scope
     // after the visit process
@@ -188,6 +375,9 @@ class symbol_analyzer {
     {
         assert(func_template_def->is_template());
 
+        assert(!func_template_def->scope.expired());
+        DACHS_STATS_INCREMENT("semantics.instantiation." + func_template_def->scope.lock()->to_string());
+
         auto instantiated_func_def = ast::copy_ast(func_template_def);
         auto const enclosing_scope
             = apply_lambda(
@@ -287,7 +477,7 @@ class symbol_analyzer {
         // Set the lambda object's type to appropriate places
         new_param->type = lambda_type;
         lambda_object_sym->type = lambda_type;
-        for (auto const& c : invocation_map.template get<semantics::tags::offset>()) {
+        for (auto const& c : invocation_map) {
             auto const var = get_as<ast::node::var_ref>(c.introduced->child);
             assert(var);
             (*var)->type = lambda_type;
@@ -330,7 +520,7 @@ class symbol_analyzer {
         if (helper::exists(captures, lambda_func)) {
             // Note:
             // Substitute captured values as its fields
-            for (auto const& c : captures.at(lambda_func).template get<semantics::tags::offset>()) {
+            for (auto const& c : captures.at(lambda_func)) {
                 auto const s = c.refered_symbol.lock();
                 auto const new_var_ref = helper::make<ast::node::var_ref>(s->name);
                 new_var_ref->symbol = c.refered_symbol;
@@ -358,6 +548,11 @@ public:
         : current_scope{root}, global{global}, already_visited_functions(fs)
     {}
 
+    template<class Scope>
+    explicit symbol_analyzer(Scope const& root, scope::global_scope const& global, bool const only_reachable) noexcept
+        : current_scope{root}, global{global}, only_reachable(only_reachable)
+    {}
+
     size_t num_errors() const noexcept
     {
         return failed;
@@ -746,6 +941,13 @@ public:
             return;
         }
 
+        // Note:
+        // Keys are hashed and compared by the runtime.  It only knows builtin types.
+        if (!key_type_elem0.is_builtin()) {
+            semantic_error(dict_lit, boost::format("Key of dictionary must be a builtin type but actually '%1%'") % key_type_elem0.to_string());
+            return;
+        }
+
         dict_lit->type = type::make<type::dict_type>(key_type_elem0, value_type_elem0);
     }
 
@@ -837,6 +1039,44 @@ public:
                 return;
             }
             access->type = dict_type->value_type;
+        } else if (auto const simd = type::get_simd_vector_info(child_type)) {
+            if (index_type != type::get_builtin_type("int", type::no_opt)
+                && index_type != type::get_builtin_type("uint", type::no_opt)) {
+                semantic_error(
+                        access,
+                        boost::format("Index of SIMD vector must be int or uint but actually '%1%'")
+                            % index_type.to_string()
+                    );
+                return;
+            }
+
+            if (auto const lit = get_as<ast::node::primary_literal>(access->index_expr)) {
+                auto const maybe_int_lit = get_as<int>((*lit)->value);
+                auto const maybe_uint_lit = get_as<unsigned int>((*lit)->value);
+                if ((maybe_int_lit && (*maybe_int_lit < 0 || static_cast<unsigned int>(*maybe_int_lit) >= simd->lanes))
+                    || (maybe_uint_lit && *maybe_uint_lit >= simd->lanes)) {
+                    semantic_error(access, boost::format("Lane index is out of bounds of '%1%'") % child_type.to_string());
+                    return;
+                }
+            }
+
+            access->type = simd->element_type;
+        } else if (child_type.is_builtin("string")) {
+            // Note:
+            // 's[i]' is a character and 's[a..b]' or 's[a...b]' is a slice sharing characters with 's'
+            auto const int_type = type::get_builtin_type("int", type::no_opt);
+            auto const uint_type = type::get_builtin_type("uint", type::no_opt);
+            if (index_type == int_type || index_type == uint_type) {
+                access->type = type::get_builtin_type("char", type::no_opt);
+            } else if (auto const range = type::get<type::range_type>(index_type)) {
+                if ((*range)->element_type != int_type && (*range)->element_type != uint_type) {
+                    semantic_error(access, boost::format("Range to slice string must be a range of int or uint but actually '%1%'") % index_type.to_string());
+                    return;
+                }
+                access->type = child_type;
+            } else {
+                semantic_error(access, boost::format("Index of string must be int, uint or range of them but actually '%1%'") % index_type.to_string());
+            }
         } else {
             semantic_error(
                 access,
@@ -845,6 +1085,15 @@ public:
         }
     }
 
+    // Note:
+    // Ranges are only for counted loops.  Floating point ranges are not supported
+    // because their trip counts can't be calculated exactly.
+    bool is_range_element_type(type::type const& t) const
+    {
+        auto const builtin = type::get<type::builtin_type>(t);
+        return builtin && helper::any_of({"int", "uint", "char"}, (*builtin)->name);
+    }
+
     template<class Walker>
     void visit(ast::node::binary_expr const& bin_expr, Walker const& recursive_walker)
     {
@@ -872,6 +1121,23 @@ public:
             return;
         }
 
+        // Note:
+        // Operators on SIMD vectors are element-wise and their results are vectors.
+        // Comparisons resulting in a vector of bool and ranges of vectors are not supported.
+        if (type::get_simd_vector_info(lhs_type)
+                && helper::any_of({"==", "!=", ">", "<", ">=", "<=", "&&", "||", "..", "..."}, bin_expr->op)) {
+            semantic_error(bin_expr, boost::format("Operator '%1%' is not available for SIMD vector type '%2%'") % bin_expr->op % lhs_type.to_string());
+            return;
+        }
+
+        // Note:
+        // Strings are concatenated by '+' and compared in lexicographical order
+        if (lhs_type.is_builtin("string")
+                && !helper::any_of({"+", "==", "!=", ">", "<", ">=", "<="}, bin_expr->op)) {
+            semantic_error(bin_expr, boost::format("Operator '%1%' is not available for string") % bin_expr->op);
+            return;
+        }
+
         // TODO:
         // Find operator function and get the result type of it
         if (helper::any_of({"==", "!=", ">", "<", ">=", "<="}, bin_expr->op)) {
@@ -882,8 +1148,11 @@ public:
             }
             bin_expr->type = type::get_builtin_type("bool", type::no_opt);
         } else if (bin_expr->op == ".." || bin_expr->op == "...") {
-            // TODO: Range type
-            throw not_implemented_error{bin_expr, __FILE__, __func__, __LINE__, "builtin range type"};
+            if (!is_range_element_type(lhs_type)) {
+                semantic_error(bin_expr, boost::format("Element of range must be int, uint or char but actually '%1%'") % lhs_type.to_string());
+                return;
+            }
+            bin_expr->type = type::make<type::range_type>(lhs_type, bin_expr->op == "..");
         } else {
             bin_expr->type = lhs_type;
         }
@@ -940,6 +1209,36 @@ public:
         if_->type = then_type;
     }
 
+    // Note:
+    // print() and println() accept builtin values except for SIMD vectors, and tuples of them
+    static bool is_printable(type::type const& t)
+    {
+        if (auto const builtin = type::get<type::builtin_type>(t)) {
+            return !type::get_simd_vector_info(*builtin);
+        }
+
+        if (auto const tuple = type::get<type::tuple_type>(t)) {
+            for (auto const& e : (*tuple)->element_types) {
+                if (!is_printable(e)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    static ast::node::any_expr const& receiver_of(ast::node::func_invocation const& invocation)
+    {
+        return invocation->args[0];
+    }
+
+    static ast::node::any_expr const& receiver_of(ast::node::ufcs_invocation const& ufcs)
+    {
+        return ufcs->child;
+    }
+
     template<class Node, class ArgTypes>
     boost::optional<std::string> visit_invocation(Node const& node, std::string const& func_name, ArgTypes const& arg_types)
     {
@@ -965,6 +1264,79 @@ public:
         auto func = *maybe_func;
 
         if (func->is_builtin) {
+            if (func->name == "print" || func->name == "println") {
+                for (auto const& t : arg_types) {
+                    if (!is_printable(t)) {
+                        return (boost::format("'%1%' can't be printed by %2%()") % t.to_string() % func->name).str();
+                    }
+                }
+            } else if (func->name == "push") {
+                auto const maybe_array_type = type::get<type::array_type>(arg_types[0]);
+                if (!maybe_array_type || (*maybe_array_type)->size) {
+                    return (boost::format("1st argument of push() must be dynamically sized array but actually '%1%'") % arg_types[0].to_string()).str();
+                }
+
+                if ((*maybe_array_type)->element_type != arg_types[1]) {
+                    return (boost::format("2nd argument of push() must be '%1%' but actually '%2%'")
+                                % (*maybe_array_type)->element_type.to_string()
+                                % arg_types[1].to_string()).str();
+                }
+
+                // Note:
+                // push() modifies the array as assignment does
+                auto const the_var_ref = var_ref_getter_for_lhs_of_assign{}.visit(receiver_of(node));
+                if (the_var_ref && !the_var_ref->symbol.expired() && the_var_ref->symbol.lock()->immutable) {
+                    return (boost::format("Can't push to immutable variable '%1%'") % the_var_ref->name).str();
+                }
+            } else if (func->name == "step") {
+                auto const maybe_range_type = type::get<type::range_type>(arg_types[0]);
+                if (!maybe_range_type) {
+                    return (boost::format("1st argument of step() must be range but actually '%1%'") % arg_types[0].to_string()).str();
+                }
+
+                if ((*maybe_range_type)->element_type != arg_types[1]) {
+                    return (boost::format("2nd argument of step() must be '%1%' but actually '%2%'")
+                                % (*maybe_range_type)->element_type.to_string()
+                                % arg_types[1].to_string()).str();
+                }
+
+                // Note:
+                // step() returns the same type of range as its 1st argument
+                node->type = arg_types[0];
+                node->callee_scope = func;
+                return boost::none;
+            } else if (func->name == "shuffle") {
+                auto const simd = type::get_simd_vector_info(arg_types[0]);
+                if (!simd) {
+                    return (boost::format("1st argument of shuffle() must be SIMD vector but actually '%1%'") % arg_types[0].to_string()).str();
+                }
+
+                // Note:
+                // Mask is an int vector which has the same number of lanes.  Whether it is
+                // a constant or not is checked in code generation.
+                auto const mask = type::get_simd_vector_info(arg_types[1]);
+                if (!mask || mask->element_type->name != "int" || mask->lanes != simd->lanes) {
+                    return (boost::format("2nd argument of shuffle() must be 'int%1%' but actually '%2%'")
+                                % simd->lanes
+                                % arg_types[1].to_string()).str();
+                }
+
+                node->type = arg_types[0];
+                node->callee_scope = func;
+                return boost::none;
+            } else if (boost::algorithm::starts_with(func->name, "reduce_")) {
+                auto const simd = type::get_simd_vector_info(arg_types[0]);
+                if (!simd) {
+                    return (boost::format("Argument of %1%() must be SIMD vector but actually '%2%'") % func->name % arg_types[0].to_string()).str();
+                }
+
+                // Note:
+                // Horizontal reduction returns a scalar of the element type
+                node->type = simd->element_type;
+                node->callee_scope = func;
+                return boost::none;
+            }
+
             assert(func->ret_type);
             node->type = *func->ret_type;
             node->callee_scope = func;
@@ -982,7 +1354,11 @@ public:
             captures[func] = analyze_as_lambda_invocation(func_def, func);
         }
 
-        if (!func_def->ret_type) {
+        // Note:
+        // The callee is analyzed on demand when it is not visited yet.
+        // This discovers the call graph from the entry point and makes it possible
+        // to analyze only reachable functions (see visit(ast::node::inu)).
+        if (!func_def->ret_type || already_visited_functions.find(func_def) == std::end(already_visited_functions)) {
             auto saved_current_scope = current_scope;
             current_scope = global; // enclosing scope of function scope is always global scope
             ast::walk_topdown(func_def, *this);
@@ -1266,9 +1642,45 @@ public:
         }
     }
 
+    template<class Loop>
+    void check_loop_hints(Loop const& loop, bool const parallel_available)
+    {
+        for (auto const& hint : loop->hints) {
+            if (hint.first == "parallel" && parallel_available) {
+                if (hint.second) {
+                    semantic_error(loop, "Loop hint '@parallel' takes no argument");
+                }
+            } else if (hint.first != "vectorize" && hint.first != "unroll") {
+                semantic_error(loop, boost::format("Unknown loop hint '@%1%'") % hint.first);
+            }
+        }
+    }
+
+    void check_parallel_for(ast::node::for_stmt const& for_, type::type const& range_t)
+    {
+        if (!type::is_a<type::array_type>(range_t) && !type::is_a<type::range_type>(range_t)) {
+            semantic_error(for_, boost::format("Range of parallel for must be array or range but actually '%1%'") % range_t.to_string());
+            return;
+        }
+
+        local_symbols_collector collector;
+        ast::walk_topdown(for_->body_stmts, collector);
+        for (auto const& p : for_->iter_vars) {
+            if (!p->param_symbol.expired()) {
+                collector.locals.insert(p->param_symbol.lock());
+            }
+        }
+
+        auto const reporter = [this](auto const& node, auto const& msg){ semantic_error(node, msg); };
+        std::unordered_set<scope::func_scope> visited_callees;
+        parallel_body_checker<decltype(reporter)> checker{collector.locals, reporter, visited_callees};
+        ast::walk_topdown(for_->body_stmts, checker);
+    }
+
     template<class Walker>
     void visit(ast::node::for_stmt const& for_, Walker const& recursive_walker)
     {
+        check_loop_hints(for_, true);
         recursive_walker(for_->iter_vars, for_->range_expr);
 
         auto const range_t = type_of(for_->range_expr);
@@ -1336,6 +1748,10 @@ public:
         }
 
         recursive_walker(for_->body_stmts);
+
+        if (for_->is_parallel()) {
+            check_parallel_for(for_, range_t);
+        }
     }
 
     void check_condition_expr(ast::node::any_expr const& expr)
@@ -1354,6 +1770,7 @@ public:
     template<class Walker>
     void visit(ast::node::while_stmt const& while_, Walker const& recursive_walker)
     {
+        check_loop_hints(while_, false);
         recursive_walker();
         check_condition_expr(while_->condition);
     }
@@ -1560,6 +1977,20 @@ public:
                 semantic_error(assign, boost::format("Can't assign to immutable variable '%1%'") % var_sym->name);
                 return;
             }
+
+            // Note:
+            // Characters of a string are shared with its slices and copies.  So they are immutable.
+            if (auto const access = get_as<ast::node::index_access>(lhs)) {
+                if (type::type_of((*access)->child).is_builtin("string")) {
+                    semantic_error(assign, "Can't assign to a character of string because string is immutable");
+                    return;
+                }
+            }
+
+            if (assign->op != "=" && assign->op != "+=" && type::type_of(lhs).is_builtin("string")) {
+                semantic_error(assign, boost::format("Operator '%1%' is not available for string") % assign->op);
+                return;
+            }
         }
 
         auto const check_types =
@@ -1623,10 +2054,79 @@ public:
         }
     }
 
+    bool is_entry_point(ast::node::global_definition const& def) const noexcept
+    {
+        auto const maybe_func_def = get_as<ast::node::function_definition>(def);
+        return !maybe_func_def || (*maybe_func_def)->name == "main";
+    }
+
+    bool is_reached(ast::node::global_definition const& def) const noexcept
+    {
+        auto const maybe_func_def = get_as<ast::node::function_definition>(def);
+        if (!maybe_func_def) {
+            return true;
+        }
+
+        auto const& func_def = *maybe_func_def;
+        if (func_def->is_template()) {
+            // Note:
+            // Function template itself is never walked.  It is reached if at least
+            // one instantiated function is reached.
+            return !func_def->instantiated.empty();
+        }
+
+        return already_visited_functions.find(func_def) != std::end(already_visited_functions);
+    }
+
+    void visit_only_reachable(ast::node::inu const& inu)
+    {
+        // Note:
+        // Global constants and main function are the entry points.  Other functions are
+        // analyzed on demand by visit_invocation().  When the program has no main function
+        // (e.g. a library compiled to an object file), all functions are exported and must
+        // be analyzed.
+        auto const has_main
+            = boost::algorithm::any_of(
+                    inu->definitions,
+                    [](auto const& d)
+                    {
+                        auto const maybe_func_def = get_as<ast::node::function_definition>(d);
+                        return maybe_func_def && (*maybe_func_def)->name == "main";
+                    }
+                );
+
+        if (!has_main) {
+            ast::walk_topdown(inu->definitions, *this);
+            return;
+        }
+
+        for (auto &def : inu->definitions) {
+            if (is_entry_point(def)) {
+                ast::walk_topdown(def, *this);
+            }
+        }
+
+        // Note:
+        // Drop unreachable functions from the AST.  They are not analyzed, so code generation
+        // must not see them.
+        inu->definitions.erase(
+                std::remove_if(
+                    std::begin(inu->definitions),
+                    std::end(inu->definitions),
+                    [this](auto const& d){ return !is_reached(d); }
+                ),
+                std::end(inu->definitions)
+            );
+    }
+
     template<class Walker>
     void visit(ast::node::inu const& inu, Walker const& recursive_walker)
     {
-        recursive_walker();
+        if (only_reachable) {
+            visit_only_reachable(inu);
+        } else {
+            recursive_walker();
+        }
 
         inu->definitions.insert(
                 std::end(inu->definitions),
@@ -1696,9 +2196,9 @@ bool check_main_func(std::vector<Func> const& funcs)
 
 } // namespace detail
 
-semantics_context check_semantics(ast::ast &a, scope::scope_tree &t)
+semantics_context check_semantics(ast::ast &a, scope::scope_tree &t, bool const only_reachable)
 {
-    detail::symbol_analyzer resolver{t.root, t.root};
+    detail::symbol_analyzer resolver{t.root, t.root, only_reachable};
     ast::walk_topdown(a.root, resolver);
     auto const failed = resolver.num_errors();
 
@@ -1706,8 +2206,10 @@ semantics_context check_semantics(ast::ast &a, scope::scope_tree &t)
         throw semantic_check_error{failed, "symbol resolution"};
     }
 
+    // Note:
+    // Effects and escapes are analyzed after this check (see semantic_analysis.cpp)
     // TODO
-    return {t, resolver.get_lambda_captures(), resolver.get_lambda_instantiation_map()};
+    return {t, resolver.get_lambda_captures(), resolver.get_lambda_instantiation_map(), {}, {}};
 }
 
 } // namespace semantics
@@ -8,7 +8,10 @@
 namespace dachs {
 namespace semantics {
 
-semantics_context check_semantics(ast::ast &a, scope::scope_tree &t);
+// Note:
+// When only_reachable is true, only functions reachable from main function are analyzed and
+// unreachable ones are removed from the AST.
+semantics_context check_semantics(ast::ast &a, scope::scope_tree &t, bool const only_reachable = false);
 
 } // namespace semantics
 } // namespace dachs
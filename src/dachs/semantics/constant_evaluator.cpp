@@ -0,0 +1,901 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <utility>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/variant/variant.hpp>
+#include <boost/optional.hpp>
+
+#include "dachs/ast/ast.hpp"
+#include "dachs/ast/ast_walker.hpp"
+#include "dachs/semantics/constant_evaluator.hpp"
+#include "dachs/semantics/scope.hpp"
+#include "dachs/semantics/symbol.hpp"
+#include "dachs/semantics/type.hpp"
+#include "dachs/statistics.hpp"
+#include "dachs/helper/variant.hpp"
+#include "dachs/helper/make.hpp"
+
+namespace dachs {
+namespace semantics {
+namespace detail {
+
+using std::size_t;
+using helper::variant::get_as;
+using helper::variant::apply_lambda;
+
+// Note:
+// Values are held with the same width as LLVM IR ('int' and 'uint' are i64).
+using constant = boost::variant<bool, char, std::int64_t, std::uint64_t, double>;
+using maybe_constant = boost::optional<constant>;
+using constant_table = std::unordered_map<symbol::var_symbol, constant>;
+
+// Note:
+// Operations below mirror tmp_builtin_unary_op_ir_emitter and tmp_builtin_bin_op_ir_emitter.
+// When the result of an operation is undefined in LLVM IR (e.g. division by zero or too wide shift),
+// the operation is not folded.
+
+template<class Int>
+maybe_constant fold_integer_bin_op(std::string const& op, Int const l, Int const r, unsigned const bits)
+{
+    using uint = typename std::make_unsigned<Int>::type;
+    bool const is_signed = std::is_signed<Int>::value;
+
+    if (op == "+") {
+        return constant{static_cast<Int>(static_cast<uint>(l) + static_cast<uint>(r))};
+    } else if (op == "-") {
+        return constant{static_cast<Int>(static_cast<uint>(l) - static_cast<uint>(r))};
+    } else if (op == "*") {
+        return constant{static_cast<Int>(static_cast<uint>(l) * static_cast<uint>(r))};
+    } else if (op == "/" || op == "%") {
+        if (r == 0 || (is_signed && l == std::numeric_limits<Int>::min() && r == static_cast<Int>(-1))) {
+            return boost::none;
+        }
+        return constant{op == "/" ? static_cast<Int>(l / r) : static_cast<Int>(l % r)};
+    } else if (op == "<<" || op == ">>") {
+        if (static_cast<uint>(r) >= bits) {
+            return boost::none;
+        }
+        if (op == "<<") {
+            return constant{static_cast<Int>(static_cast<uint>(l) << r)};
+        }
+        // Note: '>>' is always an arithmetic shift.
+        using sint = typename std::make_signed<Int>::type;
+        return constant{static_cast<Int>(static_cast<sint>(l) >> r)};
+    } else if (op == "&" || op == "&&") {
+        return constant{static_cast<Int>(l & r)};
+    } else if (op == "|" || op == "||") {
+        return constant{static_cast<Int>(l | r)};
+    } else if (op == "^") {
+        return constant{static_cast<Int>(l ^ r)};
+    } else if (op == "<") {
+        return constant{l < r};
+    } else if (op == ">") {
+        return constant{l > r};
+    } else if (op == "<=") {
+        return constant{l <= r};
+    } else if (op == ">=") {
+        return constant{l >= r};
+    } else if (op == "==") {
+        return constant{l == r};
+    } else if (op == "!=") {
+        return constant{l != r};
+    }
+
+    return boost::none;
+}
+
+inline maybe_constant fold_char_bin_op(std::string const& op, char const l, char const r)
+{
+    auto const result = fold_integer_bin_op<std::int64_t>(op, l, r, 8u);
+    if (!result) {
+        return boost::none;
+    }
+
+    if (auto const i = get_as<std::int64_t>(*result)) {
+        if ((op == "/" || op == "%") && l == std::numeric_limits<char>::min() && r == -1) {
+            return boost::none;
+        }
+        // Note: Wrap around as i8
+        return constant{static_cast<char>(static_cast<std::uint8_t>(*i))};
+    }
+
+    return result;
+}
+
+inline maybe_constant fold_bool_bin_op(std::string const& op, bool const l, bool const r)
+{
+    if (op == "&" || op == "&&") {
+        return constant{l && r};
+    } else if (op == "|" || op == "||") {
+        return constant{l || r};
+    } else if (op == "^" || op == "!=") {
+        return constant{l != r};
+    } else if (op == "==") {
+        return constant{l == r};
+    }
+
+    // Note:
+    // Other operations on i1 (e.g. signed comparison) are rarely intended.  Leave them to codegen.
+    return boost::none;
+}
+
+inline maybe_constant fold_float_bin_op(std::string const& op, double const l, double const r)
+{
+    bool const unordered = std::isnan(l) || std::isnan(r);
+
+    if (op == "+") {
+        return constant{l + r};
+    } else if (op == "-") {
+        return constant{l - r};
+    } else if (op == "*") {
+        return constant{l * r};
+    } else if (op == "/") {
+        return constant{l / r};
+    } else if (op == "%") {
+        return constant{std::fmod(l, r)};
+    } else if (op == "<") {
+        return constant{unordered || l < r};
+    } else if (op == ">") {
+        return constant{unordered || l > r};
+    } else if (op == "<=") {
+        return constant{unordered || l <= r};
+    } else if (op == ">=") {
+        return constant{unordered || l >= r};
+    } else if (op == "==") {
+        return constant{unordered || l == r};
+    } else if (op == "!=") {
+        return constant{unordered || l != r};
+    }
+
+    return boost::none;
+}
+
+inline maybe_constant fold_bin_op(std::string const& op, constant const& lhs, constant const& rhs)
+{
+    if (lhs.which() != rhs.which()) {
+        return boost::none;
+    }
+
+    if (auto const l = get_as<std::int64_t>(lhs)) {
+        return fold_integer_bin_op<std::int64_t>(op, *l, boost::get<std::int64_t>(rhs), 64u);
+    } else if (auto const l = get_as<std::uint64_t>(lhs)) {
+        return fold_integer_bin_op<std::uint64_t>(op, *l, boost::get<std::uint64_t>(rhs), 64u);
+    } else if (auto const l = get_as<double>(lhs)) {
+        return fold_float_bin_op(op, *l, boost::get<double>(rhs));
+    } else if (auto const l = get_as<char>(lhs)) {
+        return fold_char_bin_op(op, *l, boost::get<char>(rhs));
+    } else if (auto const l = get_as<bool>(lhs)) {
+        return fold_bool_bin_op(op, *l, boost::get<bool>(rhs));
+    }
+
+    return boost::none;
+}
+
+inline maybe_constant fold_unary_op(std::string const& op, constant const& operand)
+{
+    if (op == "+") {
+        return operand;
+    }
+
+    if (auto const i = get_as<std::int64_t>(operand)) {
+        if (op == "-") {
+            return constant{static_cast<std::int64_t>(-static_cast<std::uint64_t>(*i))};
+        } else if (op == "~" || op == "!") {
+            return constant{~*i};
+        }
+    } else if (auto const u = get_as<std::uint64_t>(operand)) {
+        if (op == "~" || op == "!") {
+            return constant{~*u};
+        }
+    } else if (auto const f = get_as<double>(operand)) {
+        if (op == "-") {
+            return constant{-*f};
+        }
+    } else if (auto const c = get_as<char>(operand)) {
+        if (op == "-") {
+            return constant{static_cast<char>(static_cast<std::uint8_t>(-static_cast<std::uint8_t>(*c)))};
+        } else if (op == "~" || op == "!") {
+            return constant{static_cast<char>(~*c)};
+        }
+    } else if (auto const b = get_as<bool>(operand)) {
+        if (op == "~" || op == "!") {
+            return constant{!*b};
+        }
+    }
+
+    return boost::none;
+}
+
+inline maybe_constant literal_to_constant(ast::node::primary_literal const& lit)
+{
+    if (auto const i = get_as<int>(lit->value)) {
+        return constant{static_cast<std::int64_t>(*i)};
+    } else if (auto const u = get_as<unsigned int>(lit->value)) {
+        return constant{static_cast<std::uint64_t>(*u)};
+    } else if (auto const f = get_as<double>(lit->value)) {
+        return constant{*f};
+    } else if (auto const c = get_as<char>(lit->value)) {
+        return constant{*c};
+    } else if (auto const b = get_as<bool>(lit->value)) {
+        return constant{*b};
+    }
+
+    // Note: String literals are not folded.
+    return boost::none;
+}
+
+inline boost::optional<ast::node::primary_literal> constant_to_literal(constant const& c, type::type const& t)
+{
+    auto const builtin = type::get<type::builtin_type>(t);
+    if (!builtin) {
+        return boost::none;
+    }
+    auto const& name = (*builtin)->name;
+
+    if (auto const i = get_as<std::int64_t>(c)) {
+        if (name == "int"
+            && std::numeric_limits<int>::min() <= *i
+            && *i <= std::numeric_limits<int>::max()) {
+            return helper::make<ast::node::primary_literal>(static_cast<int>(*i));
+        }
+    } else if (auto const u = get_as<std::uint64_t>(c)) {
+        if (name == "uint" && *u <= std::numeric_limits<unsigned int>::max()) {
+            return helper::make<ast::node::primary_literal>(static_cast<unsigned int>(*u));
+        }
+    } else if (auto const f = get_as<double>(c)) {
+        if (name == "float") {
+            return helper::make<ast::node::primary_literal>(*f);
+        }
+    } else if (auto const ch = get_as<char>(c)) {
+        if (name == "char") {
+            return helper::make<ast::node::primary_literal>(*ch);
+        }
+    } else if (auto const b = get_as<bool>(c)) {
+        if (name == "bool") {
+            return helper::make<ast::node::primary_literal>(*b);
+        }
+    }
+
+    return boost::none;
+}
+
+// Note:
+// Results shared by all evaluations while folding a program.  Nodes are folded bottom-up, so
+// without them an expression which can't be folded would be evaluated again at each of its
+// ancestors, and the same invocation would be interpreted at each of them.
+struct evaluation_memo {
+    // Note:
+    // Expressions which failed to be folded.  They are held to keep their addresses unique.
+    std::unordered_set<std::shared_ptr<ast::node_type::expression const>> unfoldables;
+
+    // Note:
+    // Results of invocations of pure functions.  A failure caused by the limits of steps or
+    // call depth is also memoized.  It only makes the folding conservative.
+    std::map<std::pair<scope::func_scope, std::vector<constant>>, maybe_constant> invocations;
+};
+
+inline std::shared_ptr<ast::node_type::expression const> as_expression(ast::node::any_expr const& e)
+{
+    return apply_lambda([](auto const& n) -> std::shared_ptr<ast::node_type::expression const> { return n; }, e);
+}
+
+// Note:
+// Interprets expressions and bodies of pure functions.  Any node which may have a side effect
+// (e.g. an invocation of builtin function or a procedure), which handles non-builtin values or
+// which is not supported yet makes the evaluation fail.  So an evaluated expression is always pure.
+class evaluator {
+    enum class flow {
+        next,
+        returned,
+        failed,
+    };
+
+    using frame_type = std::unordered_map<symbol::var_symbol, constant>;
+
+    constant_table const& immutables;
+    evaluation_memo &memo;
+    std::vector<frame_type> frames;
+    maybe_constant returned_value;
+    size_t steps = 0u;
+
+    bool step() noexcept
+    {
+        return ++steps <= max_steps;
+    }
+
+    maybe_constant lookup(symbol::var_symbol const& sym) const
+    {
+        if (!frames.empty()) {
+            auto const local = frames.back().find(sym);
+            if (local != std::end(frames.back())) {
+                return local->second;
+            }
+        }
+
+        auto const imm = immutables.find(sym);
+        if (imm != std::end(immutables)) {
+            return imm->second;
+        }
+
+        return boost::none;
+    }
+
+    maybe_constant eval_node(ast::node::primary_literal const& lit)
+    {
+        return literal_to_constant(lit);
+    }
+
+    maybe_constant eval_node(ast::node::typed_expr const& typed)
+    {
+        return eval(typed->child_expr);
+    }
+
+    maybe_constant eval_node(ast::node::var_ref const& var)
+    {
+        if (var->symbol.expired()) {
+            return boost::none;
+        }
+        return lookup(var->symbol.lock());
+    }
+
+    maybe_constant eval_node(ast::node::unary_expr const& unary)
+    {
+        auto const operand = eval(unary->expr);
+        if (!operand) {
+            return boost::none;
+        }
+        return fold_unary_op(unary->op, *operand);
+    }
+
+    maybe_constant eval_node(ast::node::binary_expr const& bin)
+    {
+        auto const lhs = eval(bin->lhs);
+        if (!lhs) {
+            return boost::none;
+        }
+
+        auto const rhs = eval(bin->rhs);
+        if (!rhs) {
+            return boost::none;
+        }
+
+        return fold_bin_op(bin->op, *lhs, *rhs);
+    }
+
+    maybe_constant eval_node(ast::node::if_expr const& if_)
+    {
+        auto const cond = eval_condition(if_->condition_expr, if_->kind);
+        if (!cond) {
+            return boost::none;
+        }
+        return eval(*cond ? if_->then_expr : if_->else_expr);
+    }
+
+    maybe_constant eval_node(ast::node::func_invocation const& invocation)
+    {
+        if (invocation->do_block || invocation->is_monad_invocation || invocation->callee_scope.expired()) {
+            return boost::none;
+        }
+
+        // Note:
+        // The callee must be statically determined.  Invoking a function object may have side effects.
+        if (!get_as<ast::node::var_ref>(invocation->child)) {
+            return boost::none;
+        }
+
+        std::vector<constant> args;
+        args.reserve(invocation->args.size());
+        for (auto const& a : invocation->args) {
+            auto const arg = eval(a);
+            if (!arg) {
+                return boost::none;
+            }
+            args.push_back(*arg);
+        }
+
+        return invoke(invocation->callee_scope.lock(), args);
+    }
+
+    maybe_constant eval_node(ast::node::ufcs_invocation const& ufcs)
+    {
+        // Note:
+        // When callee_scope is expired, the invocation accesses a data member.
+        if (ufcs->do_block || ufcs->callee_scope.expired()) {
+            return boost::none;
+        }
+
+        auto const receiver = eval(ufcs->child);
+        if (!receiver) {
+            return boost::none;
+        }
+
+        return invoke(ufcs->callee_scope.lock(), {*receiver});
+    }
+
+    template<class Node>
+    maybe_constant eval_node(Node const&)
+    {
+        return boost::none;
+    }
+
+    boost::optional<bool> eval_condition(ast::node::any_expr const& cond, ast::symbol::if_kind const kind)
+    {
+        auto const value = eval(cond);
+        if (!value) {
+            return boost::none;
+        }
+
+        auto const b = get_as<bool>(*value);
+        if (!b) {
+            return boost::none;
+        }
+
+        return kind == ast::symbol::if_kind::if_ ? *b : !*b;
+    }
+
+    maybe_constant invoke(scope::func_scope const& callee, std::vector<constant> const& args)
+    {
+        if (callee->is_builtin || callee->is_anonymous() || callee->is_template()) {
+            return boost::none;
+        }
+
+        if (frames.size() >= max_call_depth) {
+            return boost::none;
+        }
+
+        auto const def = callee->get_ast_node();
+        if (def->kind == ast::symbol::func_kind::proc
+            || def->ensure_body
+            || !def->ret_type
+            || def->params.size() != args.size()) {
+            return boost::none;
+        }
+
+        frame_type frame;
+        for (size_t i = 0u; i < args.size(); ++i) {
+            auto const& param = def->params[i];
+            if (param->param_symbol.expired()) {
+                return boost::none;
+            }
+            frame.emplace(param->param_symbol.lock(), args[i]);
+        }
+
+        auto key = std::make_pair(callee, args);
+        auto const memoized = memo.invocations.find(key);
+        if (memoized != std::end(memo.invocations)) {
+            return memoized->second;
+        }
+
+        frames.push_back(std::move(frame));
+        auto const result = exec(def->body);
+        frames.pop_back();
+
+        maybe_constant value;
+        if (result == flow::returned) {
+            value = std::move(returned_value);
+        }
+        returned_value = boost::none;
+
+        memo.invocations.emplace(std::move(key), value);
+        return value;
+    }
+
+    bool assign(ast::node::any_expr const& lhs, constant const& value)
+    {
+        auto const var = get_as<ast::node::var_ref>(lhs);
+        if (!var || (*var)->symbol.expired() || frames.empty()) {
+            return false;
+        }
+
+        auto &frame = frames.back();
+        auto const target = frame.find((*var)->symbol.lock());
+        if (target == std::end(frame)) {
+            // Note: Only local variables can be modified.
+            return false;
+        }
+
+        target->second = value;
+        return true;
+    }
+
+    flow exec_node(ast::node::statement_block const& block)
+    {
+        for (auto const& s : block->value) {
+            auto const f = exec(s);
+            if (f != flow::next) {
+                return f;
+            }
+        }
+        return flow::next;
+    }
+
+    flow exec_node(ast::node::return_stmt const& ret)
+    {
+        if (ret->ret_exprs.size() != 1u) {
+            return flow::failed;
+        }
+
+        returned_value = eval(ret->ret_exprs[0]);
+        return returned_value ? flow::returned : flow::failed;
+    }
+
+    flow exec_node(ast::node::if_stmt const& if_)
+    {
+        auto const cond = eval_condition(if_->condition, if_->kind);
+        if (!cond) {
+            return flow::failed;
+        }
+
+        if (*cond) {
+            return exec_node(if_->then_stmts);
+        }
+
+        for (auto const& elseif : if_->elseif_stmts_list) {
+            auto const elseif_cond = eval_condition(elseif.first, ast::symbol::if_kind::if_);
+            if (!elseif_cond) {
+                return flow::failed;
+            }
+            if (*elseif_cond) {
+                return exec_node(elseif.second);
+            }
+        }
+
+        if (if_->maybe_else_stmts) {
+            return exec_node(*if_->maybe_else_stmts);
+        }
+
+        return flow::next;
+    }
+
+    flow exec_node(ast::node::case_stmt const& case_)
+    {
+        for (auto const& when : case_->when_stmts_list) {
+            auto const cond = eval_condition(when.first, ast::symbol::if_kind::if_);
+            if (!cond) {
+                return flow::failed;
+            }
+            if (*cond) {
+                return exec_node(when.second);
+            }
+        }
+
+        if (case_->maybe_else_stmts) {
+            return exec_node(*case_->maybe_else_stmts);
+        }
+
+        return flow::next;
+    }
+
+    flow exec_node(ast::node::switch_stmt const& switch_)
+    {
+        auto const target = eval(switch_->target_expr);
+        if (!target) {
+            return flow::failed;
+        }
+
+        for (auto const& when : switch_->when_stmts_list) {
+            for (auto const& c : when.first) {
+                auto const value = eval(c);
+                if (!value) {
+                    return flow::failed;
+                }
+                auto const matched = fold_bin_op("==", *target, *value);
+                if (!matched || !get_as<bool>(*matched)) {
+                    return flow::failed;
+                }
+                if (boost::get<bool>(*matched)) {
+                    return exec_node(when.second);
+                }
+            }
+        }
+
+        if (switch_->maybe_else_stmts) {
+            return exec_node(*switch_->maybe_else_stmts);
+        }
+
+        return flow::next;
+    }
+
+    flow exec_node(ast::node::while_stmt const& while_)
+    {
+        while (true) {
+            if (!step()) {
+                return flow::failed;
+            }
+
+            auto const cond = eval_condition(while_->condition, ast::symbol::if_kind::if_);
+            if (!cond) {
+                return flow::failed;
+            }
+            if (!*cond) {
+                return flow::next;
+            }
+
+            auto const f = exec_node(while_->body_stmts);
+            if (f != flow::next) {
+                return f;
+            }
+        }
+    }
+
+    flow exec_node(ast::node::assignment_stmt const& assign_)
+    {
+        if (assign_->assignees.size() != assign_->rhs_exprs.size()) {
+            return flow::failed;
+        }
+
+        // Note: Evaluate all rhs before assignment to deal with swapping like 'a, b = b, a'
+        std::vector<constant> values;
+        values.reserve(assign_->rhs_exprs.size());
+        for (auto const& e : assign_->rhs_exprs) {
+            auto const v = eval(e);
+            if (!v) {
+                return flow::failed;
+            }
+            values.push_back(*v);
+        }
+
+        for (size_t i = 0u; i < values.size(); ++i) {
+            auto const& lhs = assign_->assignees[i];
+            auto value = values[i];
+
+            if (assign_->op != "=") {
+                // Note: Compound assignment such as '+='
+                auto const lhs_value = eval(lhs);
+                if (!lhs_value) {
+                    return flow::failed;
+                }
+                auto const result = fold_bin_op(assign_->op.substr(0, assign_->op.size() - 1), *lhs_value, value);
+                if (!result) {
+                    return flow::failed;
+                }
+                value = *result;
+            }
+
+            if (!assign(lhs, value)) {
+                return flow::failed;
+            }
+        }
+
+        return flow::next;
+    }
+
+    flow exec_node(ast::node::initialize_stmt const& init)
+    {
+        if (frames.empty()
+            || !init->maybe_rhs_exprs
+            || init->maybe_rhs_exprs->size() != init->var_decls.size()) {
+            return flow::failed;
+        }
+
+        auto const& rhs_exprs = *init->maybe_rhs_exprs;
+        for (size_t i = 0u; i < rhs_exprs.size(); ++i) {
+            auto const& decl = init->var_decls[i];
+            if (decl->symbol.expired()) {
+                return flow::failed;
+            }
+
+            auto const value = eval(rhs_exprs[i]);
+            if (!value) {
+                return flow::failed;
+            }
+
+            frames.back()[decl->symbol.lock()] = *value;
+        }
+
+        return flow::next;
+    }
+
+    flow exec_node(ast::node::postfix_if_stmt const& postfix_if)
+    {
+        auto const cond = eval_condition(postfix_if->condition, postfix_if->kind);
+        if (!cond) {
+            return flow::failed;
+        }
+
+        if (!*cond) {
+            return flow::next;
+        }
+
+        return apply_lambda([this](auto const& s){ return exec_node(s); }, postfix_if->body);
+    }
+
+    flow exec_node(ast::node::let_stmt const& let)
+    {
+        for (auto const& i : let->inits) {
+            auto const f = exec_node(i);
+            if (f != flow::next) {
+                return f;
+            }
+        }
+
+        return exec(let->child_stmt);
+    }
+
+    flow exec_node(ast::node::any_expr const& e)
+    {
+        // Note:
+        // An expression statement whose value can't be evaluated may have side effects.
+        return eval(e) ? flow::next : flow::failed;
+    }
+
+    template<class Node>
+    flow exec_node(Node const&)
+    {
+        return flow::failed;
+    }
+
+    flow exec(ast::node::compound_stmt const& s)
+    {
+        if (!step()) {
+            return flow::failed;
+        }
+        return apply_lambda([this](auto const& n){ return exec_node(n); }, s);
+    }
+
+public:
+
+    static size_t const max_steps = 100000u;
+    static size_t const max_call_depth = 64u;
+
+    evaluator(constant_table const& imm, evaluation_memo &m) noexcept
+        : immutables(imm), memo(m)
+    {}
+
+    maybe_constant eval(ast::node::any_expr const& e)
+    {
+        if (!step()) {
+            return boost::none;
+        }
+
+        // Note:
+        // Out of function bodies, a subexpression which failed to be folded fails again
+        if (frames.empty() && memo.unfoldables.count(as_expression(e)) != 0u) {
+            return boost::none;
+        }
+
+        return apply_lambda([this](auto const& n){ return this->eval_node(n); }, e);
+    }
+
+    maybe_constant evaluate(ast::node::any_expr const& e)
+    {
+        steps = 0u;
+        frames.clear();
+        returned_value = boost::none;
+        return eval(e);
+    }
+};
+
+class constant_folder {
+    constant_table immutables;
+    evaluation_memo memo;
+
+    static bool is_foldable_type(type::type const& t)
+    {
+        auto const builtin = type::get<type::builtin_type>(t);
+        if (!builtin) {
+            return false;
+        }
+
+        auto const& name = (*builtin)->name;
+        return name == "int" || name == "uint" || name == "float" || name == "char" || name == "bool";
+    }
+
+public:
+
+    template<class Walker>
+    void visit(ast::node::inu &inu, Walker const& w)
+    {
+        // Note:
+        // Global constants are folded at first because functions can refer them.
+        for (auto &def : inu->definitions) {
+            if (auto const init = get_as<ast::node::initialize_stmt>(def)) {
+                w(*init);
+            }
+        }
+
+        for (auto &def : inu->definitions) {
+            if (auto const func = get_as<ast::node::function_definition>(def)) {
+                w(*func);
+            }
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::function_definition &func, Walker const& w)
+    {
+        // Note:
+        // Function templates are not typed.  Fold instantiated functions instead.
+        if (func->is_template()) {
+            for (auto &i : func->instantiated) {
+                w(i);
+            }
+            return;
+        }
+
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::initialize_stmt &init, Walker const& w)
+    {
+        w();
+
+        if (!init->maybe_rhs_exprs || init->maybe_rhs_exprs->size() != init->var_decls.size()) {
+            return;
+        }
+
+        auto const& rhs_exprs = *init->maybe_rhs_exprs;
+        for (size_t i = 0u; i < rhs_exprs.size(); ++i) {
+            auto const& decl = init->var_decls[i];
+            if (decl->is_var || decl->symbol.expired()) {
+                continue;
+            }
+
+            auto const sym = decl->symbol.lock();
+            if (!sym->immutable) {
+                continue;
+            }
+
+            auto const lit = get_as<ast::node::primary_literal>(rhs_exprs[i]);
+            if (!lit) {
+                continue;
+            }
+
+            if (auto const c = literal_to_constant(*lit)) {
+                immutables.emplace(sym, *c);
+            }
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::any_expr &e, Walker const& w)
+    {
+        // Note: Fold in bottom-up order
+        w();
+
+        if (get_as<ast::node::primary_literal>(e)) {
+            return;
+        }
+
+        auto const t = type::type_of(e);
+        auto const value = t && is_foldable_type(t) ? evaluator{immutables, memo}.evaluate(e) : boost::none;
+        auto const lit = value ? constant_to_literal(*value, t) : boost::none;
+        if (!lit) {
+            memo.unfoldables.insert(as_expression(e));
+            return;
+        }
+
+        (*lit)->type = t;
+        apply_lambda([&lit](auto const& n){ (*lit)->set_source_location(*n); }, e);
+        e = *lit;
+
+        DACHS_STATS_INCREMENT("semantics.folded_constants");
+    }
+
+    template<class Node, class Walker>
+    void visit(Node &, Walker const& w)
+    {
+        w();
+    }
+};
+
+} // namespace detail
+
+void evaluate_constants(ast::ast &a)
+{
+    detail::constant_folder folder;
+    ast::walk_topdown(a.root, folder);
+}
+
+} // namespace semantics
+} // namespace dachs
@@ -0,0 +1,20 @@
+#if !defined DACHS_SEMANTICS_CONSTANT_EVALUATOR_HPP_INCLUDED
+#define      DACHS_SEMANTICS_CONSTANT_EVALUATOR_HPP_INCLUDED
+
+#include "dachs/ast/ast_fwd.hpp"
+
+namespace dachs {
+namespace semantics {
+
+// Note:
+// Fold constant expressions in the typed AST into literals.
+// Literal arithmetic, references to immutable variables initialized with constants and
+// invocations of pure functions with constant arguments are evaluated at compile time.
+// An expression which can't be evaluated (e.g. it has side effects, exceeds the step or
+// depth limit or results in undefined behavior) is left as it is.
+void evaluate_constants(ast::ast &a);
+
+} // namespace semantics
+} // namespace dachs
+
+#endif    // DACHS_SEMANTICS_CONSTANT_EVALUATOR_HPP_INCLUDED
@@ -0,0 +1,348 @@
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+
+#include "dachs/ast/ast.hpp"
+#include "dachs/ast/ast_walker.hpp"
+#include "dachs/semantics/effect_analyzer.hpp"
+#include "dachs/semantics/scope.hpp"
+#include "dachs/semantics/symbol.hpp"
+#include "dachs/semantics/type.hpp"
+#include "dachs/helper/variant.hpp"
+
+namespace dachs {
+namespace semantics {
+namespace detail {
+
+using helper::variant::get_as;
+using helper::variant::apply_lambda;
+
+using global_vars_type = std::unordered_set<symbol::var_symbol>;
+
+struct func_effect_info {
+    func_effect effect = func_effect::none;
+    std::unordered_set<scope::func_scope> callees;
+
+    void add(func_effect const e) noexcept
+    {
+        if (effect < e) {
+            effect = e;
+        }
+    }
+};
+
+struct root_var_getter {
+
+    template<class... Args>
+    ast::node::var_ref visit(boost::variant<Args...> const& v) const
+    {
+        return apply_lambda([this](auto const& n){ return visit(n); }, v);
+    }
+
+    ast::node::var_ref visit(ast::node::var_ref const& ref) const
+    {
+        return ref;
+    }
+
+    ast::node::var_ref visit(ast::node::index_access const& access) const
+    {
+        return visit(access->child);
+    }
+
+    ast::node::var_ref visit(ast::node::typed_expr const& typed) const
+    {
+        return visit(typed->child_expr);
+    }
+
+    template<class T>
+    ast::node::var_ref visit(T const&) const
+    {
+        return nullptr;
+    }
+};
+
+// Note:
+// Elements of dynamically sized array and dictionary are placed in the heap.
+inline bool has_heap_elems(type::type const& t)
+{
+    if (auto const array = type::get<type::array_type>(t)) {
+        return !(*array)->size;
+    }
+    return type::is_a<type::dict_type>(t);
+}
+
+// Note:
+// Elements of dynamically sized array and dictionary are shared among copies of them.
+// Assigning to them may affect caller's memory even if the container is a local variable.
+struct shared_elem_finder {
+
+    template<class... Args>
+    bool visit(boost::variant<Args...> const& v) const
+    {
+        return apply_lambda([this](auto const& n){ return visit(n); }, v);
+    }
+
+    bool visit(ast::node::index_access const& access) const
+    {
+        if (has_heap_elems(type::type_of(access->child))) {
+            return true;
+        }
+        return visit(access->child);
+    }
+
+    bool visit(ast::node::typed_expr const& typed) const
+    {
+        return visit(typed->child_expr);
+    }
+
+    template<class T>
+    bool visit(T const&) const
+    {
+        return false;
+    }
+};
+
+// Note:
+// Collect the effect of a function body itself and its callees.
+// Lambda bodies are not visited here because they are separate functions.
+class effect_collector {
+    global_vars_type const& globals;
+    func_effect_info &info;
+
+    bool is_global(ast::node::var_ref const& var) const
+    {
+        return !var->symbol.expired() && globals.find(var->symbol.lock()) != std::end(globals);
+    }
+
+    template<class Scope>
+    void add_callee(Scope const& callee_scope)
+    {
+        if (callee_scope.expired()) {
+            // Note: Unknown callee
+            info.add(func_effect::write);
+            return;
+        }
+
+        auto const callee = callee_scope.lock();
+        if (callee->is_builtin) {
+            // Note: Builtin functions are I/O functions such as print and println
+            info.add(func_effect::write);
+            return;
+        }
+
+        info.callees.insert(callee);
+    }
+
+public:
+
+    effect_collector(global_vars_type const& g, func_effect_info &i) noexcept
+        : globals(g), info(i)
+    {}
+
+    template<class Walker>
+    void visit(ast::node::var_ref const& var, Walker const&)
+    {
+        if (is_global(var)) {
+            info.add(func_effect::read);
+        }
+    }
+
+    // Note:
+    // Elements in the heap may be modified through other copies of the container.
+    // Looking up a dictionary aborts the program when the key is not found.  It must not
+    // be eliminated even if the result is unused, so it is considered as a write.
+    template<class Walker>
+    void visit(ast::node::index_access const& access, Walker const& w)
+    {
+        w();
+        auto const child_type = type::type_of(access->child);
+        if (type::is_a<type::dict_type>(child_type)) {
+            info.add(func_effect::write);
+        } else if (has_heap_elems(child_type)) {
+            info.add(func_effect::read);
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::for_stmt const& for_, Walker const& w)
+    {
+        w();
+        if (has_heap_elems(type::type_of(for_->range_expr))) {
+            info.add(func_effect::read);
+        }
+    }
+
+    // Note:
+    // Allocation is a write.  Otherwise two calls allocating containers could be merged
+    // into one and the results would alias.
+    template<class Walker>
+    void visit(ast::node::object_construct const& construct, Walker const& w)
+    {
+        w();
+        if (has_heap_elems(construct->type)) {
+            info.add(func_effect::write);
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::dict_literal const&, Walker const& w)
+    {
+        w();
+        info.add(func_effect::write);
+    }
+
+    // Note:
+    // Concatenation of strings allocates the result (and aborts on failure)
+    template<class Walker>
+    void visit(ast::node::binary_expr const& bin_expr, Walker const& w)
+    {
+        w();
+        if (bin_expr->op == "+" && type::type_of(bin_expr->lhs).is_builtin("string")) {
+            info.add(func_effect::write);
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::func_invocation const& invocation, Walker const& w)
+    {
+        w();
+        add_callee(invocation->callee_scope);
+    }
+
+    template<class Walker>
+    void visit(ast::node::ufcs_invocation const& ufcs, Walker const& w)
+    {
+        w();
+
+        // Note:
+        // When callee_scope is expired, the invocation is an access to a data member.
+        // Reading the receiver is already considered when visiting the child except for
+        // the size of dictionary, which is in the heap.
+        if (!ufcs->callee_scope.expired()) {
+            add_callee(ufcs->callee_scope);
+        } else if (type::is_a<type::dict_type>(type::type_of(ufcs->child))) {
+            info.add(func_effect::read);
+        }
+    }
+
+    template<class Walker>
+    void visit(ast::node::assignment_stmt const& assign, Walker const& w)
+    {
+        w();
+
+        // Note:
+        // Mutable variables are always copied.  So assigning to a local variable
+        // or its element doesn't affect caller's memory.  's += t' concatenates strings.
+        for (auto const& lhs : assign->assignees) {
+            auto const var = root_var_getter{}.visit(lhs);
+            if (!var || is_global(var) || shared_elem_finder{}.visit(lhs)
+                    || (assign->op == "+=" && type::type_of(lhs).is_builtin("string"))) {
+                info.add(func_effect::write);
+            }
+        }
+    }
+
+    template<class Node, class Walker>
+    void visit(Node const&, Walker const& w)
+    {
+        w();
+    }
+};
+
+class effect_analyzer {
+    global_vars_type globals;
+    std::unordered_map<scope::func_scope, func_effect_info> infos;
+
+    void collect(ast::node::function_definition const& def)
+    {
+        if (def->is_template()) {
+            for (auto const& i : def->instantiated) {
+                collect(i);
+            }
+            return;
+        }
+
+        if (def->scope.expired()) {
+            return;
+        }
+
+        auto &info = infos[def->scope.lock()];
+
+        // Note:
+        // Aggregate parameters are passed as pointers to caller's memory
+        for (auto const& p : def->params) {
+            if (!p->type.is_builtin() && !p->type.is_unit()) {
+                info.add(func_effect::read);
+            }
+        }
+
+        effect_collector collector{globals, info};
+        ast::walk_topdown(def->body, collector);
+        if (def->ensure_body) {
+            ast::walk_topdown(*def->ensure_body, collector);
+        }
+    }
+
+public:
+
+    explicit effect_analyzer(ast::ast const& a)
+    {
+        for (auto const& d : a.root->definitions) {
+            if (auto const init = get_as<ast::node::initialize_stmt>(d)) {
+                for (auto const& decl : (*init)->var_decls) {
+                    if (!decl->symbol.expired()) {
+                        globals.insert(decl->symbol.lock());
+                    }
+                }
+            }
+        }
+
+        for (auto const& d : a.root->definitions) {
+            if (auto const func = get_as<ast::node::function_definition>(d)) {
+                collect(*func);
+            }
+        }
+    }
+
+    func_effects_type infer()
+    {
+        // Note:
+        // Propagate effects of callees until reaching the fixed point.
+        // Recursive functions are dealt with because effects only increase.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto &i : infos) {
+                auto &info = i.second;
+                for (auto const& callee : info.callees) {
+                    auto const callee_info = infos.find(callee);
+                    auto const callee_effect
+                        = callee_info == std::end(infos)
+                            ? func_effect::write
+                            : callee_info->second.effect;
+
+                    if (info.effect < callee_effect) {
+                        info.effect = callee_effect;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        func_effects_type result;
+        for (auto const& i : infos) {
+            result.emplace(i.first, i.second.effect);
+        }
+        return result;
+    }
+};
+
+} // namespace detail
+
+func_effects_type infer_func_effects(ast::ast const& a)
+{
+    return detail::effect_analyzer{a}.infer();
+}
+
+} // namespace semantics
+} // namespace dachs
@@ -0,0 +1,20 @@
+#if !defined DACHS_SEMANTICS_EFFECT_ANALYZER_HPP_INCLUDED
+#define      DACHS_SEMANTICS_EFFECT_ANALYZER_HPP_INCLUDED
+
+#include "dachs/ast/ast_fwd.hpp"
+#include "dachs/semantics/semantics_context.hpp"
+
+namespace dachs {
+namespace semantics {
+
+// Note:
+// Infer effects of all non-template functions in the typed AST over the call graph.
+// A function which invokes builtin functions (e.g. print) or assigns to global variables
+// has side effects.  A function which reads global variables or aggregate parameters is
+// readonly.  Otherwise the function doesn't access its caller's memory.
+func_effects_type infer_func_effects(ast::ast const& a);
+
+} // namespace semantics
+} // namespace dachs
+
+#endif    // DACHS_SEMANTICS_EFFECT_ANALYZER_HPP_INCLUDED
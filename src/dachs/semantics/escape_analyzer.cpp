@@ -0,0 +1,333 @@
+#include <vector>
+#include <utility>
+#include <unordered_set>
+#include <unordered_map>
+
+#include "dachs/ast/ast.hpp"
+#include "dachs/ast/ast_walker.hpp"
+#include "dachs/semantics/escape_analyzer.hpp"
+#include "dachs/semantics/scope.hpp"
+#include "dachs/semantics/symbol.hpp"
+#include "dachs/semantics/type.hpp"
+#include "dachs/helper/variant.hpp"
+#include "dachs/helper/util.hpp"
+
+namespace dachs {
+namespace semantics {
+namespace detail {
+
+using helper::variant::get_as;
+
+using allocation_sites_type = std::vector<std::pair<ast::node::object_construct, symbol::var_symbol>>;
+
+bool is_aggregate(type::type const& t)
+{
+    return t && !t.is_builtin() && !t.is_unit();
+}
+
+// Note:
+// Strings are also classified because the buffer of a concatenated string can be released
+// when the variable holding it doesn't escape (see string_ir_emitter::emit_concat()).
+bool is_tracked(type::type const& t)
+{
+    return is_aggregate(t) || (t && t.is_builtin("string"));
+}
+
+template<class Expr>
+boost::optional<ast::node::var_ref> as_var_ref(Expr const& e)
+{
+    if (auto const var = get_as<ast::node::var_ref>(e)) {
+        return *var;
+    }
+    if (auto const typed = get_as<ast::node::typed_expr>(e)) {
+        return as_var_ref((*typed)->child_expr);
+    }
+    return boost::none;
+}
+
+// Note:
+// Uses of variables are classified by their parent nodes.  The AST is walked top-down, so
+// a parent is always visited before its child variable references.  A reference whose parent
+// doesn't classify it escapes to heap.
+class escape_collector {
+    escapes_type &escapes;
+    semantics_context const& ctx;
+    allocation_sites_type &sites;
+    std::unordered_map<ast::node::var_ref, escape_kind> uses;
+    std::unordered_set<ast::node::lambda_expr> downward_lambdas;
+
+    void add(symbol::var_symbol const& sym, escape_kind const kind)
+    {
+        if (!is_tracked(sym->type)) {
+            return;
+        }
+
+        auto const result = escapes.vars.emplace(sym, kind);
+        if (!result.second && result.first->second < kind) {
+            result.first->second = kind;
+        }
+    }
+
+    template<class Expr>
+    void classify(Expr const& e, escape_kind const kind)
+    {
+        if (auto const var = as_var_ref(e)) {
+            uses[*var] = kind;
+        }
+    }
+
+    // Note:
+    // Elements of dynamically sized array are reallocated by push().  Other builtin
+    // functions (e.g. print) only read their arguments.
+    template<class Scope>
+    escape_kind arg_escape_of(Scope const& callee_scope) const
+    {
+        if (callee_scope.expired()) {
+            return escape_kind::heap;
+        }
+
+        auto const callee = callee_scope.lock();
+        if (callee->is_builtin) {
+            return callee->name == "push" ? escape_kind::heap : escape_kind::none;
+        }
+
+        return escape_kind::callee;
+    }
+
+    // Note:
+    // Captured values are copied to the lambda object when it is created.  A do-end block
+    // given to a function is only invoked during the call.  Other lambda objects may be
+    // returned or stored.
+    void add_captures(ast::node::lambda_expr const& lambda, escape_kind const kind)
+    {
+        auto const g = type::get<type::generic_func_type>(lambda->type);
+        if (!g) {
+            return;
+        }
+
+        auto const captures = ctx.lambda_instantiation_map.find(*g);
+        if (captures == std::end(ctx.lambda_instantiation_map)) {
+            return;
+        }
+
+        for (auto const& e : captures->second->element_exprs) {
+            auto const var = as_var_ref(e);
+            if (var && !(*var)->symbol.expired()) {
+                add((*var)->symbol.lock(), kind);
+            }
+        }
+    }
+
+public:
+
+    escape_collector(escapes_type &e, semantics_context const& c, allocation_sites_type &s) noexcept
+        : escapes(e), ctx(c), sites(s)
+    {}
+
+    template<class Walker>
+    void visit(ast::node::var_ref const& var, Walker const&)
+    {
+        if (var->symbol.expired()) {
+            return;
+        }
+
+        auto const use = uses.find(var);
+        add(var->symbol.lock(), use == std::end(uses) ? escape_kind::heap : use->second);
+    }
+
+    template<class Walker>
+    void visit(ast::node::initialize_stmt const& init, Walker const& w)
+    {
+        for (auto const& decl : init->var_decls) {
+            if (!decl->symbol.expired()) {
+                add(decl->symbol.lock(), escape_kind::none);
+            }
+        }
+
+        if (init->maybe_rhs_exprs && init->maybe_rhs_exprs->size() == init->var_decls.size()) {
+            for (auto const idx : helper::indices(init->var_decls.size())) {
+                auto const& decl = init->var_decls[idx];
+                auto const construct = get_as<ast::node::object_construct>((*init->maybe_rhs_exprs)[idx]);
+                if (construct && !decl->symbol.expired()) {
+                    sites.emplace_back(*construct, decl->symbol.lock());
+                }
+            }
+        }
+
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::assignment_stmt const& assign, Walker const& w)
+    {
+        // Note:
+        // Assigning to a variable itself only rebinds it.  Values in rhs may escape
+        // because they are shared with the assignee.
+        for (auto const& lhs : assign->assignees) {
+            classify(lhs, escape_kind::none);
+        }
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::index_access const& access, Walker const& w)
+    {
+        // Note:
+        // A slice of string refers to the characters of the source string
+        if (!type::type_of(access->child).is_builtin("string") || !access->type.is_builtin("string")) {
+            classify(access->child, escape_kind::none);
+        }
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::binary_expr const& bin_expr, Walker const& w)
+    {
+        // Note:
+        // Operators of strings only read their operands.  The result of concatenation may
+        // share the buffer of the 1st operand, but the buffer is reference counted.
+        if (type::type_of(bin_expr->lhs).is_builtin("string")) {
+            classify(bin_expr->lhs, escape_kind::none);
+            classify(bin_expr->rhs, escape_kind::none);
+        }
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::for_stmt const& for_, Walker const& w)
+    {
+        // Note:
+        // A string is referred during the loop, so the body must not release it
+        // even if it assigns to the variable of the string.
+        classify(
+                for_->range_expr,
+                type::type_of(for_->range_expr).is_builtin("string") ?
+                    escape_kind::callee :
+                    escape_kind::none
+            );
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::func_invocation const& invocation, Walker const& w)
+    {
+        classify(invocation->child, escape_kind::none);
+
+        auto const kind = arg_escape_of(invocation->callee_scope);
+        for (auto const& arg : invocation->args) {
+            if (auto const lambda = get_as<ast::node::lambda_expr>(arg)) {
+                if (kind != escape_kind::heap) {
+                    downward_lambdas.insert(*lambda);
+                }
+            } else {
+                classify(arg, kind);
+            }
+        }
+
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::ufcs_invocation const& ufcs, Walker const& w)
+    {
+        // Note:
+        // When callee_scope is expired, the invocation is an access to a data member.
+        classify(
+                ufcs->child,
+                ufcs->callee_scope.expired() ?
+                    escape_kind::none :
+                    arg_escape_of(ufcs->callee_scope)
+            );
+
+        if (ufcs->do_block_object) {
+            add_captures(*ufcs->do_block_object, escape_kind::callee);
+        }
+
+        w();
+    }
+
+    template<class Walker>
+    void visit(ast::node::lambda_expr const& lambda, Walker const&)
+    {
+        add_captures(
+                lambda,
+                downward_lambdas.find(lambda) != std::end(downward_lambdas) ?
+                    escape_kind::callee :
+                    escape_kind::heap
+            );
+    }
+
+    template<class Node, class Walker>
+    void visit(Node const&, Walker const& w)
+    {
+        w();
+    }
+};
+
+class escape_analyzer {
+    semantics_context const& ctx;
+    escapes_type escapes;
+    allocation_sites_type sites;
+
+    void collect(ast::node::function_definition const& def)
+    {
+        if (def->is_template()) {
+            for (auto const& i : def->instantiated) {
+                collect(i);
+            }
+            return;
+        }
+
+        for (auto const& p : def->params) {
+            if (!p->param_symbol.expired()) {
+                auto const sym = p->param_symbol.lock();
+                if (is_tracked(sym->type)) {
+                    escapes.vars.emplace(sym, escape_kind::none);
+                }
+            }
+        }
+
+        escape_collector collector{escapes, ctx, sites};
+        ast::walk_topdown(def->body, collector);
+        if (def->ensure_body) {
+            ast::walk_topdown(*def->ensure_body, collector);
+        }
+    }
+
+public:
+
+    escape_analyzer(ast::ast const& a, semantics_context const& c)
+        : ctx(c)
+    {
+        for (auto const& d : a.root->definitions) {
+            if (auto const func = get_as<ast::node::function_definition>(d)) {
+                collect(*func);
+            }
+        }
+    }
+
+    escapes_type analyze()
+    {
+        // Note:
+        // Variables are classified after all uses are visited because a captured variable
+        // is found on visiting its lambda object.
+        for (auto const& site : sites) {
+            auto const var = escapes.vars.find(site.second);
+            escapes.allocations.emplace(
+                    site.first,
+                    var == std::end(escapes.vars) ? escape_kind::heap : var->second
+                );
+        }
+        return std::move(escapes);
+    }
+};
+
+} // namespace detail
+
+escapes_type analyze_escapes(ast::ast const& a, semantics_context const& ctx)
+{
+    return detail::escape_analyzer{a, ctx}.analyze();
+}
+
+} // namespace semantics
+} // namespace dachs
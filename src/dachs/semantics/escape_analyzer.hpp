@@ -0,0 +1,20 @@
+#if !defined DACHS_SEMANTICS_ESCAPE_ANALYZER_HPP_INCLUDED
+#define      DACHS_SEMANTICS_ESCAPE_ANALYZER_HPP_INCLUDED
+
+#include "dachs/ast/ast_fwd.hpp"
+#include "dachs/semantics/semantics_context.hpp"
+
+namespace dachs {
+namespace semantics {
+
+// Note:
+// Classify local variables of aggregate types and strings in the typed AST by how far their values may
+// escape from their frames, and object constructions which initialize the variables by the
+// same classification.  Captured variables are classified by the lambda objects which capture
+// them.  Any use not known to be safe is considered to escape to heap.
+escapes_type analyze_escapes(ast::ast const& a, semantics_context const& ctx);
+
+} // namespace semantics
+} // namespace dachs
+
+#endif    // DACHS_SEMANTICS_ESCAPE_ANALYZER_HPP_INCLUDED
@@ -11,33 +11,100 @@ scope::scope_tree analyze_symbols_forward(ast::ast &a)
         auto dummy_template_type = type::make<type::template_type>(a.root);
         // Builtin functions
 
+        // Note:
+        // print() and println() are variadic.  They are defined for each number of arguments
+        // up to max_print_args.  println() without argument only ends the line.
+        std::size_t const max_print_args = 16u;
+        for (auto const name : {"print", "println"}) {
+            // func print(value1, value2, ...)
+            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, name, true, true);
+            for (auto num_args = std::string{name} == "print" ? 1u : 0u; num_args <= max_print_args; ++num_args) {
+                auto print_func = scope::make<scope::func_scope>(nullptr, scope_root, name, true);
+                print_func->body = scope::make<scope::local_scope>(print_func);
+                print_func->ret_type = type::get_unit_type();
+                // Note: These definitions are never duplicate
+                for (std::size_t i = 1u; i <= num_args; ++i) {
+                    auto p = symbol::make<symbol::var_symbol>(nullptr, "value" + std::to_string(i), true, true);
+                    p->type = dummy_template_type;
+                    print_func->define_param(std::move(p));
+                }
+                scope_root->define_function(print_func);
+                if (num_args == 1u) {
+                    func_var_sym->type = type::make<type::generic_func_type>(print_func);
+                }
+            }
+            scope_root->define_global_function_constant(std::move(func_var_sym));
+        }
+
         {
-            // func print(str)
-            auto print_func = scope::make<scope::func_scope>(nullptr, scope_root, "print", true);
-            print_func->body = scope::make<scope::local_scope>(print_func);
-            print_func->ret_type = type::get_unit_type();
+            // func push(array, elem)
+            auto push_func = scope::make<scope::func_scope>(nullptr, scope_root, "push", true);
+            push_func->body = scope::make<scope::local_scope>(push_func);
+            push_func->ret_type = type::get_unit_type();
             // Note: These definitions are never duplicate
-            auto p = symbol::make<symbol::var_symbol>(nullptr, "value", true, true);
-            p->type = dummy_template_type;
-            print_func->define_param(std::move(p));
-            scope_root->define_function(print_func);
-            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, "print", true, true);
-            func_var_sym->type = type::make<type::generic_func_type>(print_func);
+            auto p1 = symbol::make<symbol::var_symbol>(nullptr, "array", true, true);
+            p1->type = dummy_template_type;
+            push_func->define_param(std::move(p1));
+            auto p2 = symbol::make<symbol::var_symbol>(nullptr, "elem", true, true);
+            p2->type = dummy_template_type;
+            push_func->define_param(std::move(p2));
+            scope_root->define_function(push_func);
+            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, "push", true, true);
+            func_var_sym->type = type::make<type::generic_func_type>(push_func);
+            scope_root->define_global_function_constant(std::move(func_var_sym));
+        }
+
+        {
+            // func step(range, step)
+            auto step_func = scope::make<scope::func_scope>(nullptr, scope_root, "step", true);
+            step_func->body = scope::make<scope::local_scope>(step_func);
+            // Note: Actual return type is the type of 1st argument.  It is decided in semantic analysis.
+            step_func->ret_type = type::get_unit_type();
+            // Note: These definitions are never duplicate
+            auto p1 = symbol::make<symbol::var_symbol>(nullptr, "range", true, true);
+            p1->type = dummy_template_type;
+            step_func->define_param(std::move(p1));
+            auto p2 = symbol::make<symbol::var_symbol>(nullptr, "step", true, true);
+            p2->type = dummy_template_type;
+            step_func->define_param(std::move(p2));
+            scope_root->define_function(step_func);
+            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, "step", true, true);
+            func_var_sym->type = type::make<type::generic_func_type>(step_func);
             scope_root->define_global_function_constant(std::move(func_var_sym));
         }
 
         {
-            // func println(str)
-            auto println_func = scope::make<scope::func_scope>(nullptr, scope_root, "println", true);
-            println_func->body = scope::make<scope::local_scope>(println_func);
-            println_func->ret_type = type::get_unit_type();
+            // func shuffle(vector, mask)
+            auto shuffle_func = scope::make<scope::func_scope>(nullptr, scope_root, "shuffle", true);
+            shuffle_func->body = scope::make<scope::local_scope>(shuffle_func);
+            // Note: Actual return type is the type of 1st argument.  It is decided in semantic analysis.
+            shuffle_func->ret_type = type::get_unit_type();
+            // Note: These definitions are never duplicate
+            auto p1 = symbol::make<symbol::var_symbol>(nullptr, "vector", true, true);
+            p1->type = dummy_template_type;
+            shuffle_func->define_param(std::move(p1));
+            auto p2 = symbol::make<symbol::var_symbol>(nullptr, "mask", true, true);
+            p2->type = dummy_template_type;
+            shuffle_func->define_param(std::move(p2));
+            scope_root->define_function(shuffle_func);
+            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, "shuffle", true, true);
+            func_var_sym->type = type::make<type::generic_func_type>(shuffle_func);
+            scope_root->define_global_function_constant(std::move(func_var_sym));
+        }
+
+        for (auto const name : {"reduce_add", "reduce_mul", "reduce_min", "reduce_max"}) {
+            // func reduce_xxx(vector)
+            auto reduce_func = scope::make<scope::func_scope>(nullptr, scope_root, name, true);
+            reduce_func->body = scope::make<scope::local_scope>(reduce_func);
+            // Note: Actual return type is the element type of the argument.  It is decided in semantic analysis.
+            reduce_func->ret_type = type::get_unit_type();
             // Note: These definitions are never duplicate
-            auto p = symbol::make<symbol::var_symbol>(nullptr, "value", true, true);
+            auto p = symbol::make<symbol::var_symbol>(nullptr, "vector", true, true);
             p->type = dummy_template_type;
-            println_func->define_param(std::move(p));
-            scope_root->define_function(println_func);
-            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, "println", true, true);
-            func_var_sym->type = type::make<type::generic_func_type>(println_func);
+            reduce_func->define_param(std::move(p));
+            scope_root->define_function(reduce_func);
+            auto func_var_sym = symbol::make<symbol::var_symbol>(nullptr, name, true, true);
+            func_var_sym->type = type::make<type::generic_func_type>(reduce_func);
             scope_root->define_global_function_constant(std::move(func_var_sym));
         }
 
@@ -10,6 +10,7 @@
 #include <boost/variant/apply_visitor.hpp>
 
 #include "dachs/fatal.hpp"
+#include "dachs/statistics.hpp"
 #include "dachs/ast/ast.hpp"
 #include "dachs/ast/ast_walker.hpp"
 #include "dachs/semantics/symbol.hpp"
@@ -116,8 +117,9 @@ class lambda_capture_resolver {
         new_invocation->type = var->type;
 
         auto const result = captures.insert({new_invocation, offset, var->symbol});
-        assert(result.second);
+        assert(result);
         (void) result;
+        DACHS_STATS_INCREMENT("semantics.lambda_captures");
 
         ++offset;
         return new_invocation;
@@ -12,6 +12,7 @@
 #include "dachs/exception.hpp"
 #include "dachs/helper/variant.hpp"
 #include "dachs/helper/util.hpp"
+#include "dachs/statistics.hpp"
 
 namespace dachs {
 namespace scope_node {
@@ -70,6 +71,8 @@ get_overloaded_function(Funcs const& candidates, std::string const& name, Types
             continue;
         }
 
+        DACHS_STATS_INCREMENT("semantics.resolve_func.candidates");
+
         auto const score_tmp = detail::get_overloaded_function_score(f, arg_types);
         if (score_tmp > score) {
             score = score_tmp;
@@ -85,6 +88,7 @@ get_overloaded_function(Funcs const& candidates, std::string const& name, Types
 boost::optional<scope::func_scope>
 global_scope::resolve_func(std::string const& name, std::vector<type::type> const& arg_types) const
 {
+    DACHS_STATS_INCREMENT("semantics.resolve_func.calls");
     return detail::get_overloaded_function(functions, name, arg_types);
 }
 
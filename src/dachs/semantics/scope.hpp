@@ -10,6 +10,7 @@
 #include <boost/algorithm/string/predicate.hpp>
 
 #include "dachs/warning.hpp"
+#include "dachs/statistics.hpp"
 #include "dachs/semantics/scope_fwd.hpp"
 #include "dachs/semantics/type.hpp"
 #include "dachs/semantics/symbol.hpp"
@@ -138,7 +139,9 @@ struct global_scope final : public basic_scope {
     template<class RootType>
     global_scope(RootType const& ast_root) noexcept
         : basic_scope(), ast_root(ast_root)
-    {}
+    {
+        DACHS_STATS_INCREMENT("scope.global");
+    }
 
     // Check function duplication after forward analysis because of overload resolution
     void define_function(scope::func_scope const& new_func) noexcept
@@ -187,7 +190,9 @@ struct local_scope final : public basic_scope {
     template<class AnyScope>
     explicit local_scope(AnyScope const& enclosing) noexcept
         : basic_scope(enclosing)
-    {}
+    {
+        DACHS_STATS_INCREMENT("scope.local");
+    }
 
     void define_child(scope::local_scope const& child) noexcept
     {
@@ -223,7 +228,9 @@ struct func_scope final : public basic_scope, public symbol_node::basic_symbol {
     explicit func_scope(Node const& n, P const& p, std::string const& s, bool const is_builtin = false) noexcept
         : basic_scope(p)
         , basic_symbol(n, s, is_builtin)
-    {}
+    {
+        DACHS_STATS_INCREMENT("scope.func");
+    }
 
     func_scope(func_scope const&) = default;
 
@@ -303,7 +310,9 @@ struct class_scope final : public basic_scope, public symbol_node::basic_symbol
     explicit class_scope(Node const& ast_node, Parent const& p, std::string const& name, bool const is_builtin = false) noexcept
         : basic_scope(p)
         , basic_symbol(ast_node, name, is_builtin)
-    {}
+    {
+        DACHS_STATS_INCREMENT("scope.class");
+    }
 
     bool define_member_func(scope::func_scope const& new_func) noexcept
     {
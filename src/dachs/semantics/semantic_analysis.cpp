@@ -11,14 +11,21 @@
 #include "dachs/semantics/scope.hpp"
 #include "dachs/semantics/forward_analyzer.hpp"
 #include "dachs/semantics/analyzer.hpp"
+#include "dachs/semantics/constant_evaluator.hpp"
+#include "dachs/semantics/effect_analyzer.hpp"
+#include "dachs/semantics/escape_analyzer.hpp"
 
 namespace dachs {
 namespace semantics {
 
-semantics_context analyze_semantics(ast::ast &a)
+semantics_context analyze_semantics(ast::ast &a, bool const only_reachable)
 {
     auto tree = analyze_symbols_forward(a);
-    return check_semantics(a, tree);
+    auto ctx = check_semantics(a, tree, only_reachable);
+    evaluate_constants(a);
+    ctx.func_effects = infer_func_effects(a);
+    ctx.escapes = analyze_escapes(a, ctx);
+    return ctx;
 
     // TODO: Get type of global function variables' type on visit node::function_definition
     // Note:
@@ -9,7 +9,7 @@ namespace dachs {
 namespace semantics {
 
 // FIXME: argument should be const
-semantics_context analyze_semantics(ast::ast &a);
+semantics_context analyze_semantics(ast::ast &a, bool const only_reachable = false);
 
 } // namespace semantics
 } // namespace dachs
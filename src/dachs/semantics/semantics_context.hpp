@@ -6,10 +6,9 @@
 #include <iostream>
 #include <utility>
 #include <string>
-
-#include <boost/multi_index_container.hpp>
-#include <boost/multi_index/member.hpp>
-#include <boost/multi_index/ordered_index.hpp>
+#include <vector>
+#include <algorithm>
+#include <cassert>
 
 #include "dachs/ast/ast.hpp"
 #include "dachs/semantics/scope.hpp"
@@ -19,41 +18,125 @@
 namespace dachs {
 namespace semantics {
 
-namespace tags {
-
-struct offset{};
-struct introduced{};
-
-} // namespace tags
-
 struct lambda_capture {
     ast::node::ufcs_invocation introduced;
     std::size_t offset;
     symbol::weak_var_symbol refered_symbol;
 };
 
-namespace mi = boost::multi_index;
-
-using captured_offset_map
-    = boost::multi_index_container<
-            lambda_capture,
-            mi::indexed_by<
-                mi::ordered_unique<
-                        mi::tag<tags::offset>,
-                        mi::member<lambda_capture, std::size_t, &lambda_capture::offset>
-                >,
-                mi::ordered_unique<
-                        mi::tag<tags::introduced>,
-                        mi::member<lambda_capture, ast::node::ufcs_invocation, &lambda_capture::introduced>
-                >
-            >
-        >;
+// Note:
+// Offsets of captures in a lambda are dense (0, 1, 2, ...) and the number of captures is small.
+// So captures are stored contiguously in a vector indexed by their offsets.  The lookup from
+// the introduced UFCS invocation is done with a vector of (node id, offset) sorted by node id.
+class captured_offset_map {
+    std::vector<lambda_capture> captures;
+    std::vector<std::pair<std::size_t, std::size_t>> offsets_by_id;
+
+    auto lower_bound(std::size_t const id) const
+    {
+        return std::lower_bound(
+                std::begin(offsets_by_id),
+                std::end(offsets_by_id),
+                id,
+                [](auto const& entry, auto const i){ return entry.first < i; }
+            );
+    }
+
+public:
+
+    using const_iterator = std::vector<lambda_capture>::const_iterator;
+
+    bool insert(lambda_capture const& capture)
+    {
+        assert(capture.offset == captures.size());
+
+        auto const id = capture.introduced->id;
+        auto const itr = lower_bound(id);
+        if (itr != std::end(offsets_by_id) && itr->first == id) {
+            return false;
+        }
+
+        offsets_by_id.emplace(itr, id, capture.offset);
+        captures.push_back(capture);
+        return true;
+    }
+
+    const_iterator find(ast::node::ufcs_invocation const& introduced) const
+    {
+        auto const itr = lower_bound(introduced->id);
+        if (itr == std::end(offsets_by_id) || itr->first != introduced->id) {
+            return std::end(captures);
+        }
+        return std::begin(captures) + itr->second;
+    }
+
+    lambda_capture const& operator[](std::size_t const offset) const
+    {
+        assert(offset < captures.size());
+        return captures[offset];
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return std::begin(captures);
+    }
+
+    const_iterator end() const noexcept
+    {
+        return std::end(captures);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return captures.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return captures.empty();
+    }
+};
+
 using lambda_captures_type = std::unordered_map<scope::func_scope, captured_offset_map>;
 
+// Note:
+// Effects of functions are ordered.  An effect of a function is the greatest one of
+// its own body and its callees.
+enum class func_effect {
+    none,   // Accesses no memory visible to its caller (readnone)
+    read,   // Only reads memory visible to its caller (readonly)
+    write,  // May have side effects (including aborting the program)
+};
+
+using func_effects_type = std::unordered_map<scope::func_scope, func_effect>;
+
+// Note:
+// Where a value of a local variable may be referred after it is stored.  Kinds are ordered
+// as func_effect.  A variable which is only accessed in its frame is 'none'.  A variable passed
+// to a callee (or captured by a do-end block given to the callee) may be referred during
+// the call.  Otherwise (returned, stored in other object, captured by a lambda object and so on)
+// it may outlive the frame.
+enum class escape_kind {
+    none,
+    callee,
+    heap,
+};
+
+struct escapes_type {
+    std::unordered_map<symbol::var_symbol, escape_kind> vars;
+
+    // Note:
+    // Object constructions which initialize local variables.  A construction which is not
+    // here (e.g. a temporary passed to a function directly) must be considered to escape to heap.
+    std::unordered_map<ast::node::object_construct, escape_kind> allocations;
+};
+
 struct semantics_context {
     scope::scope_tree scopes;
     lambda_captures_type lambda_captures;
     std::unordered_map<type::generic_func_type, ast::node::tuple_literal> lambda_instantiation_map;
+    func_effects_type func_effects;
+    escapes_type escapes;
 
     semantics_context(semantics_context const&) = delete;
     semantics_context &operator=(semantics_context const&) = delete;
@@ -66,7 +149,7 @@ struct semantics_context {
         out << "Lambda captures:" << std::endl;
         for (auto const& cs : lambda_captures) {
             out << "  " << cs.first->to_string() << std::endl;
-            for (auto const& c : cs.second.get<semantics::tags::offset>()) {
+            for (auto const& c : cs.second) {
                 out << "    " << c.refered_symbol.lock()->name << ':' << c.introduced->line << ':' << c.introduced->col << " -> " << c.introduced->member_name << std::endl;
             }
         }
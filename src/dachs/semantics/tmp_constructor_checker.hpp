@@ -24,24 +24,36 @@ struct ctor_checker {
         return type.apply_lambda([this, &args](auto const& t){ return (*this)(t, args); });
     }
 
+    // Note:
+    // When the size is a constant uint, the array is fixed sized.  Otherwise the array is
+    // dynamically sized.  'new [T]' constructs an empty dynamically sized array.
     template<class Exprs>
     result_type operator()(type::array_type const& a, Exprs const& args) const
     {
-        if (args.size() != 1 && args.size() != 2) {
-            return (boost::format("Invalid argument for constructor of '%1%' (%2% for 1 or 2)") % a->to_string() % args.size()).str();
+        if (args.size() > 2) {
+            return (boost::format("Invalid argument for constructor of '%1%' (%2% for 0, 1 or 2)") % a->to_string() % args.size()).str();
+        }
+
+        if (args.empty()) {
+            a->size = boost::none;
+            return boost::none;
         }
 
         auto const maybe_lit = helper::variant::get_as<ast::node::primary_literal>(args[0]);
+        auto const is_uint_literal = maybe_lit && helper::variant::has<unsigned int>((*maybe_lit)->value);
+
+        if (!is_uint_literal) {
+            auto const size_type = type::type_of(args[0]);
+            if (size_type != type::get_builtin_type("int", type::no_opt)
+                    && size_type != type::get_builtin_type("uint", type::no_opt)) {
+                return (boost::format("1st argument of constructor of '%1%' must be int or uint") % a->to_string()).str();
+            }
 
-        auto const err_msg = (boost::format("1st argument of constructor of '%1%' must be constant uint") % a->to_string()).str();
-        if (!maybe_lit) {
-            return err_msg;
+            a->size = boost::none;
+            return boost::none;
         }
 
         auto const maybe_uint = helper::variant::get_as<unsigned int>((*maybe_lit)->value);
-        if (!maybe_uint) {
-            return err_msg;
-        }
 
         if (a->size && *a->size <= *maybe_uint) {
             return (boost::format("Size is out of bounds of the array type (size:%1% , specified:%2%)") % *a->size % *maybe_uint).str();
@@ -51,6 +63,44 @@ struct ctor_checker {
         return boost::none;
     }
 
+    template<class Exprs>
+    result_type operator()(type::dict_type const& d, Exprs const& args) const
+    {
+        if (!args.empty()) {
+            return (boost::format("Invalid argument for constructor of '%1%' (%2% for 0)") % d->to_string() % args.size()).str();
+        }
+
+        if (!type::is_a<type::builtin_type>(d->key_type)) {
+            return (boost::format("Key of dictionary must be a builtin type but actually '%1%'") % d->key_type.to_string()).str();
+        }
+
+        return boost::none;
+    }
+
+    // Note:
+    // 'new float4{x}' splats x to all lanes and 'new float4{a, b, c, d}' sets each lane.
+    template<class Exprs>
+    result_type operator()(type::builtin_type const& b, Exprs const& args) const
+    {
+        auto const simd = type::get_simd_vector_info(b);
+        if (!simd) {
+            return (boost::format("Invalid constructor for '%1%'") % b->to_string()).str();
+        }
+
+        if (args.size() != 1u && args.size() != simd->lanes) {
+            return (boost::format("Invalid argument for constructor of '%1%' (%2% for 1 or %3%)") % b->to_string() % args.size() % simd->lanes).str();
+        }
+
+        for (auto const& a : args) {
+            auto const arg_type = type::type_of(a);
+            if (arg_type != simd->element_type) {
+                return (boost::format("Element of '%1%' must be '%2%' but actually '%3%'") % b->to_string() % simd->element_type->to_string() % arg_type.to_string()).str();
+            }
+        }
+
+        return boost::none;
+    }
+
     template<class T, class Exprs>
     result_type operator()(T const& t, Exprs const&) const
     {
@@ -11,7 +11,7 @@
 #include "dachs/semantics/type.hpp"
 
 // Note:
-// This class is temporary for array, tuple and range.
+// This class is temporary for array, tuple, range and string.
 // Members should be resolved by the class definitions.
 
 namespace dachs {
@@ -58,6 +58,22 @@ struct member_variable_checker : boost::static_visitor<boost::variant<type::type
         return type::type{};
     }
 
+    result_type operator()(type::dict_type const& ) const
+    {
+        if (member_name == "size") {
+            return builtin_type("uint");
+        }
+        return type::type{};
+    }
+
+    result_type operator()(type::builtin_type const& builtin) const
+    {
+        if (builtin->name == "string" && member_name == "size") {
+            return builtin_type("uint");
+        }
+        return type::type{};
+    }
+
     template<class T>
     result_type operator()(T const&) const
     {
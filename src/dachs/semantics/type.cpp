@@ -1,4 +1,6 @@
 #include <cassert>
+#include <tuple>
+#include <vector>
 #include <boost/optional.hpp>
 
 #include "dachs/ast/ast.hpp"
@@ -19,6 +21,25 @@ static std::vector<builtin_type> const builtin_types
         make<builtin_type>("bool"),
         make<builtin_type>("string"),
         make<builtin_type>("symbol"),
+        make<builtin_type>("float2"),
+        make<builtin_type>("float4"),
+        make<builtin_type>("float8"),
+        make<builtin_type>("int2"),
+        make<builtin_type>("int4"),
+        make<builtin_type>("int8"),
+    };
+
+// Note:
+// (name, element type, lanes) of SIMD vector types.  Elements are 64bit as well as scalar
+// int and float.
+static std::vector<std::tuple<char const*, char const*, unsigned int>> const simd_vector_types
+    = {
+        std::make_tuple("float2", "float", 2u),
+        std::make_tuple("float4", "float", 4u),
+        std::make_tuple("float8", "float", 8u),
+        std::make_tuple("int2", "int", 2u),
+        std::make_tuple("int4", "int", 4u),
+        std::make_tuple("int8", "int", 8u),
     };
 
 } // namespace detail
@@ -47,6 +68,17 @@ builtin_type get_builtin_type(char const* const name, no_opt_t) noexcept
     DACHS_RAISE_INTERNAL_COMPILATION_ERROR
 }
 
+boost::optional<simd_vector_info> get_simd_vector_info(builtin_type const& t) noexcept
+{
+    for (auto const& v : detail::simd_vector_types) {
+        if (t->name == std::get<0>(v)) {
+            return simd_vector_info{get_builtin_type(std::get<1>(v), no_opt), std::get<2>(v)};
+        }
+    }
+
+    return boost::none;
+}
+
 tuple_type const& get_unit_type() noexcept
 {
     static auto const unit_type = make<tuple_type>();
@@ -69,6 +69,16 @@ boost::optional<builtin_type> get_builtin_type(char const* const name) noexcept;
 builtin_type get_builtin_type(char const* const name, no_opt_t) noexcept;
 tuple_type const& get_unit_type() noexcept;
 
+// Note:
+// SIMD vector types are builtin types named by their element type and the number of
+// lanes (e.g. 'float4' is a vector of 4 floats).
+struct simd_vector_info {
+    builtin_type element_type;
+    unsigned int lanes;
+};
+
+boost::optional<simd_vector_info> get_simd_vector_info(builtin_type const& t) noexcept;
+
 namespace traits {
 
 template<class T>
@@ -537,9 +547,12 @@ struct dict_type final : public basic_type {
     }
 };
 
+// Note:
+// 'a..b' is an inclusive range and 'a...b' is an exclusive one.
+// Inclusiveness is a part of the type because the code generator decides the trip count
+// of the loop from it.
 struct range_type final : public basic_type {
     type::any_type element_type;
-    // TODO: bool is_inclusive
     bool is_inclusive;
 
     range_type() = default;
@@ -551,13 +564,13 @@ struct range_type final : public basic_type {
 
     std::string to_string() const noexcept override
     {
-        return "<range of " + element_type.to_string() + ">";
-        return "<" + ((is_inclusive ? "inclusive" : "exclusive") + ("range of " + element_type.to_string())) + ">";
+        return std::string{"<"} + (is_inclusive ? "inclusive" : "exclusive") + " range of " + element_type.to_string() + ">";
     }
 
     bool operator==(range_type const& rhs) const noexcept
     {
-        return element_type == rhs.element_type;
+        return element_type == rhs.element_type
+            && is_inclusive == rhs.is_inclusive;
     }
 
     template<class T>
@@ -727,6 +740,15 @@ inline any_type type_of(Variant const& v) noexcept
     return apply_lambda([](auto const& n){ return n->type; }, v);
 }
 
+inline boost::optional<simd_vector_info> get_simd_vector_info(any_type const& t) noexcept
+{
+    auto const builtin = get<builtin_type>(t);
+    if (!builtin) {
+        return boost::none;
+    }
+    return get_simd_vector_info(*builtin);
+}
+
 } // namespace type
 
 } // namespace dachs
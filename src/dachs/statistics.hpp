@@ -0,0 +1,77 @@
+#if !defined DACHS_STATISTICS_HPP_INCLUDED
+#define      DACHS_STATISTICS_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <map>
+#include <iostream>
+#include <iomanip>
+
+// Note:
+// Counters for --stats are collected only when DACHS_ENABLE_STATS is defined
+// (cmake -DDACHS_ENABLE_STATS=ON).  Otherwise DACHS_STATS_*() macros are expanded
+// to nothing and their arguments are never evaluated.
+
+namespace dachs {
+namespace statistics {
+
+using counters_type = std::map<std::string, std::size_t>;
+
+inline counters_type &counters() noexcept
+{
+    static counters_type c;
+    return c;
+}
+
+constexpr bool enabled() noexcept
+{
+#if defined DACHS_ENABLE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+inline void add(std::string const& key, std::size_t const n)
+{
+    counters()[key] += n;
+}
+
+inline void clear() noexcept
+{
+    counters().clear();
+}
+
+inline void report(std::ostream &out = std::cerr)
+{
+    if (!enabled()) {
+        out << "Statistics are not available.  Build Dachs with -DDACHS_ENABLE_STATS=ON." << std::endl;
+        return;
+    }
+
+    std::size_t width = 0u;
+    for (auto const& c : counters()) {
+        if (c.first.size() > width) {
+            width = c.first.size();
+        }
+    }
+
+    out << "=========Statistics=========\n\n";
+    for (auto const& c : counters()) {
+        out << std::left << std::setw(width) << c.first << " : " << c.second << '\n';
+    }
+    out << std::endl;
+}
+
+} // namespace statistics
+} // namespace dachs
+
+#if defined DACHS_ENABLE_STATS
+# define DACHS_STATS_ADD(key, n) ::dachs::statistics::add((key), (n))
+#else
+# define DACHS_STATS_ADD(key, n) ((void) 0)
+#endif
+
+#define DACHS_STATS_INCREMENT(key) DACHS_STATS_ADD(key, 1u)
+
+#endif    // DACHS_STATISTICS_HPP_INCLUDED
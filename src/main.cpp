@@ -9,19 +9,24 @@
 #include <boost/algorithm/string/classification.hpp>
 
 #include "dachs/compiler.hpp"
+#include "dachs/codegen/llvmir/context.hpp"
 #include "dachs/helper/colorizer.hpp"
 #include "dachs/exception.hpp"
+#include "dachs/statistics.hpp"
 
 namespace dachs {
 namespace cmdline {
 
 template<class Action>
-int do_compiler_action(Action const& action)
+int do_compiler_action(Action const& action, bool const show_stats)
 {
     dachs::helper::colorizer<std::string> c;
 
     try {
         action();
+        if (show_stats) {
+            dachs::statistics::report(std::cerr);
+        }
         return 0;
     }
     catch (std::runtime_error const& e) {
@@ -63,10 +68,15 @@ auto get_command_options(ArgPtr arg)
         std::vector<std::string> libdirs;
         bool debug = false;
         bool enable_color = true; 
+        bool only_reachable = false;
+        bool stats = false;
+        dachs::codegen::llvmir::target_spec target;
     } cmdopts;
 
     std::string const debug_str = "--debug";
     std::string const disable_color_str = "--disable_color";
+    std::string const only_reachable_str = "--only-reachable";
+    std::string const stats_str = "--stats";
 
     for (; *arg; ++arg) {
         if (boost::algorithm::starts_with(*arg, "--libdir=")) {
@@ -78,12 +88,23 @@ auto get_command_options(ArgPtr arg)
                     boost::is_any_of(",")
                 );
             cmdopts.libdirs.insert(std::end(cmdopts.libdirs), std::begin(libs), std::end(libs));
+        } else if (boost::algorithm::starts_with(*arg, "--march=")) {
+            // Note: As GCC, --march=native means the host CPU with all its features
+            cmdopts.target.cpu = std::string{*arg}.substr(std::strlen("--march="));
+        } else if (boost::algorithm::starts_with(*arg, "--mcpu=")) {
+            cmdopts.target.cpu = std::string{*arg}.substr(std::strlen("--mcpu="));
+        } else if (boost::algorithm::starts_with(*arg, "--mattr=")) {
+            cmdopts.target.features = std::string{*arg}.substr(std::strlen("--mattr="));
         } else if (boost::algorithm::ends_with(*arg, ".dcs")) {
             cmdopts.source_files.emplace_back(*arg);
         } else if (*arg == debug_str) {
             cmdopts.debug = true;
         } else if (*arg == disable_color_str) {
             cmdopts.enable_color = false;
+        } else if (*arg == only_reachable_str) {
+            cmdopts.only_reachable = true;
+        } else if (*arg == stats_str) {
+            cmdopts.stats = true;
         } else {
             cmdopts.rest_args.emplace_back(*arg);
         }
@@ -102,13 +123,13 @@ int main(int const, char const* const argv[])
     auto const show_usage =
         [argv]()
         {
-            std::cerr << "Usage: " << argv[0] << " [--dump-ast|--dump-sym-table|--emit-llvm|--output-obj] [--debug] [--libdir={path}] {file}\n";
+            std::cerr << "Usage: " << argv[0] << " [--dump-ast|--dump-sym-table|--emit-llvm|--output-obj] [--debug] [--only-reachable] [--stats] [--libdir={path}] [--march={cpu|native}] [--mcpu={cpu}] [--mattr={features}] {file}\n";
         };
 
     // TODO: Use Boost.ProgramOptions
 
     auto const cmdopts = dachs::cmdline::get_command_options(&argv[1]);
-    dachs::compiler compiler;
+    dachs::compiler compiler{cmdopts.only_reachable, cmdopts.target};
 
     switch (cmdopts.rest_args.size()) {
 
@@ -125,6 +146,7 @@ int main(int const, char const* const argv[])
                         cmdopts.enable_color
                     );
                 }
+                , cmdopts.stats
             );
         } else if (opt == "--dump-sym-table") {
             return dachs::cmdline::do_compiler_action(
@@ -135,6 +157,7 @@ int main(int const, char const* const argv[])
                         cmdopts.source_files
                     );
                 }
+                , cmdopts.stats
             );
         } else if (opt == "--emit-llvm") {
             return dachs::cmdline::do_compiler_action(
@@ -145,6 +168,7 @@ int main(int const, char const* const argv[])
                         cmdopts.source_files
                     );
                 }
+                , cmdopts.stats
             );
         } else if (opt == "--output-obj") {
             return dachs::cmdline::do_compiler_action(
@@ -156,6 +180,7 @@ int main(int const, char const* const argv[])
                         cmdopts.debug
                     );
                 }
+                , cmdopts.stats
             );
         }
     }
@@ -173,6 +198,7 @@ int main(int const, char const* const argv[])
                         cmdopts.debug
                     );
                 }
+                , cmdopts.stats
             );
         }
     break;
@@ -7,6 +7,7 @@
 #include "dachs/semantics/scope.hpp"
 #include "dachs/semantics/semantic_analysis.hpp"
 #include "dachs/exception.hpp"
+#include "dachs/statistics.hpp"
 
 #include <string>
 
@@ -261,6 +262,762 @@ BOOST_AUTO_TEST_CASE(invocation_with_wrong_arguments)
     )");
 }
 
+BOOST_AUTO_TEST_CASE(only_reachable_functions)
+{
+    auto t = p.parse(R"(
+        func unused(a)
+            ret undefined_variable
+        end
+
+        func unused2 : int
+            ret 'a'
+        end
+
+        func used(a) : int
+            ret a
+        end
+
+        func main
+            used(42).println
+        end
+    )", "test_file");
+
+    BOOST_CHECK_NO_THROW(dachs::semantics::analyze_semantics(t, true /*only reachable*/));
+    BOOST_CHECK_EQUAL(t.root->definitions.size(), 2u);
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func unused2 : int
+            ret 'a'
+        end
+
+        func main
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(constant_evaluation)
+{
+    auto t = p.parse(R"(
+        func fib(n)
+            ret n if n < 2
+            ret fib(n-1) + fib(n-2)
+        end
+
+        func main
+            a := fib(10) * 2 + 1
+            var b := a
+            b += 1
+            c := 1 / 0
+            d := fib(30)
+        end
+    )", "test_file");
+
+    BOOST_CHECK_NO_THROW(dachs::semantics::analyze_semantics(t));
+
+    using namespace dachs::ast::node;
+    auto const main_def = boost::get<function_definition>(t.root->definitions.back());
+    auto const& stmts = main_def->body->value;
+    BOOST_CHECK_EQUAL(stmts.size(), 5u);
+
+    auto const rhs_of = [&](std::size_t const idx) -> any_expr const&
+        {
+            return (*boost::get<initialize_stmt>(stmts[idx])->maybe_rhs_exprs)[0];
+        };
+
+    auto const a = boost::get<primary_literal>(&rhs_of(0));
+    BOOST_CHECK(a);
+    BOOST_CHECK_EQUAL(boost::get<int>((*a)->value), 111);
+
+    // Note: Immutable 'a' is propagated to its reference
+    BOOST_CHECK(boost::get<primary_literal>(&rhs_of(1)));
+
+    // Note: Division by zero is not folded
+    BOOST_CHECK(boost::get<binary_expr>(&rhs_of(3)));
+
+    // Note:
+    // Results of invocations are memoized.  Without it, fib(30) needs more steps than the limit.
+    auto const d = boost::get<primary_literal>(&rhs_of(4));
+    BOOST_CHECK(d);
+    BOOST_CHECK_EQUAL(boost::get<int>((*d)->value), 832040);
+}
+
+BOOST_AUTO_TEST_CASE(function_effects)
+{
+    auto t = p.parse(R"(
+        g := (1, 2)
+
+        func square(x : int) : int
+            ret x * x
+        end
+
+        func read_global(x : int) : int
+            ret x + g[0]
+        end
+
+        func show(x : int)
+            x.println
+        end
+
+        func show_square(x : int)
+            show(square(x))
+        end
+
+        func main
+            show_square(read_global(3))
+        end
+    )", "test_file");
+
+    auto const ctx = dachs::semantics::analyze_semantics(t);
+
+    auto const effect_of
+        = [&](std::size_t const idx)
+        {
+            auto const def = boost::get<dachs::ast::node::function_definition>(t.root->definitions[idx]);
+            return ctx.func_effects.at(def->scope.lock());
+        };
+
+    using dachs::semantics::func_effect;
+    BOOST_CHECK(effect_of(1) == func_effect::none);
+    BOOST_CHECK(effect_of(2) == func_effect::read);
+    BOOST_CHECK(effect_of(3) == func_effect::write);
+    BOOST_CHECK(effect_of(4) == func_effect::write);
+}
+
+BOOST_AUTO_TEST_CASE(heap_effects)
+{
+    auto t = p.parse(R"(
+        func make_array(n : int)
+            ret new [int]{n}
+        end
+
+        func make_dict(x : int)
+            ret new {int => int}
+        end
+
+        func make_dict_literal(x : int)
+            ret {x => x}
+        end
+
+        func lookup(d, k : int) : int
+            ret d[k]
+        end
+
+        func first(a) : int
+            ret a[0]
+        end
+
+        func exclaim(s : string) : string
+            ret s + "!"
+        end
+
+        func main
+            var d := make_dict_literal(1)
+            d[2] = lookup(make_dict(1), 0)
+            println(make_array(3).size)
+            println(first(make_array(3)))
+            println(exclaim("hi"))
+        end
+    )", "test_file");
+
+    auto const ctx = dachs::semantics::analyze_semantics(t);
+
+    auto const effect_of
+        = [&](std::size_t const idx)
+        {
+            auto const def = boost::get<dachs::ast::node::function_definition>(t.root->definitions[idx]);
+            auto const scope = def->is_template() ? def->instantiated[0]->scope.lock() : def->scope.lock();
+            return ctx.func_effects.at(scope);
+        };
+
+    // Note:
+    // Allocations are writes so that two results never alias.  Elements in the heap are read.
+    // Looking up a dictionary may abort, so it is a write not to be eliminated.
+    using dachs::semantics::func_effect;
+    BOOST_CHECK(effect_of(0) == func_effect::write);
+    BOOST_CHECK(effect_of(1) == func_effect::write);
+    BOOST_CHECK(effect_of(2) == func_effect::write);
+    BOOST_CHECK(effect_of(3) == func_effect::write);
+    BOOST_CHECK(effect_of(4) == func_effect::read);
+    BOOST_CHECK(effect_of(5) == func_effect::write);
+}
+
+BOOST_AUTO_TEST_CASE(dynamic_array)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var n := 10
+            var a := new [int]{n}
+            var b := new [int]
+            push(b, 42)
+            b.push(a[0])
+            println(b.size)
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var a := new [int]{4u}
+            push(a, 42)
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var a := new [int]
+            push(a, 'c')
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var a := new [int]{3.14}
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            a := new [int]
+            push(a, 42)
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func f(a : [int])
+            a.push(42)
+        end
+
+        func main
+            f(new [int])
+        end
+    )");
+
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func f(var a : [int])
+            a.push(42)
+        end
+
+        func main
+            f(new [int])
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(dictionary)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var d := {1 => 'a', 2 => 'b'}
+            var counts := new {string => uint}
+            counts["foo"] += 1u
+            println(d[1])
+            println(counts.size)
+            for k, v in d
+                println(k)
+                println(v)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var d := {(1, 2) => 'a'}
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var d := new {int => int}{42}
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var d := {1 => 'a'}
+            for k in d
+            end
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(range)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var n := 10
+            for i in 1..n
+                println(i)
+            end
+            for var i in (0u...10u).step(3u)
+                i += 1u
+                println(i)
+            end
+            for c in 'a'..'z'
+                print(c)
+            end
+            val r := step(1..n, 2)
+            for _ in r
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            for f in 1.0..2.0
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            for i in 1..10u
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            for i in (1..10).step(2u)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var r := 1..10
+            r = 1...10
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(escape_analysis)
+{
+    auto t = p.parse(R"(
+        func each(a, block)
+            for e in a
+                block(e)
+            end
+        end
+
+        func main
+            local := new [int]{4u}
+            println(local[0])
+            passed := [1, 2, 3]
+            passed.each do |i|
+                println(i)
+            end
+            captured := (1, 2)
+            [1, 2].each do |i|
+                println(i + captured[0])
+            end
+            stored := (3, 4)
+            f := -> x in x + stored[0]
+            println(f(1))
+        end
+    )", "test_file");
+
+    auto const ctx = dachs::semantics::analyze_semantics(t);
+
+    using namespace dachs::ast::node;
+    auto const main_def = boost::get<function_definition>(t.root->definitions[1]);
+    auto const& stmts = main_def->body->value;
+    auto const escape_of
+        = [&](std::size_t const idx)
+        {
+            auto const init = boost::get<initialize_stmt>(stmts[idx]);
+            return ctx.escapes.vars.at(init->var_decls[0]->symbol.lock());
+        };
+
+    using dachs::semantics::escape_kind;
+    BOOST_CHECK(escape_of(0) == escape_kind::none);
+    BOOST_CHECK(escape_of(2) == escape_kind::callee);
+    BOOST_CHECK(escape_of(4) == escape_kind::callee);
+    BOOST_CHECK(escape_of(6) == escape_kind::heap);
+}
+
+BOOST_AUTO_TEST_CASE(loop_hints)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var i := 0
+            @vectorize @unroll(4)
+            for e in [1, 2, 3]
+                i += e
+            end
+            @vectorize(0)
+            for i < 10
+                i += 1
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            @fast
+            for e in [1, 2, 3]
+                println(e)
+            end
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func main
+            n := 100u
+            xs := new [float]{n, 1.0}
+            var ys := new [float]{n, 0.0}
+            a := 2.0
+
+            @parallel
+            for i in 0u...n
+                var y := a * xs[i]
+                y += 1.0
+                ys[i] = y
+            end
+
+            @parallel @vectorize
+            for y in ys
+                var tmp := new [float]
+                tmp.push(y)
+                println(tmp[0])
+            end
+        end
+    )");
+
+    // Note:
+    // Callees may write elements of arrays, reassign their parameters and modify
+    // containers created by themselves
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func scale(var ys, i, var a)
+            ys[i] = a * ys[i]
+            a = 0.0
+        end
+
+        func fresh(x)
+            var tmp := new [float]
+            tmp.push(x)
+            return tmp
+        end
+
+        func main
+            n := 100u
+            var ys := new [float]{n, 1.0}
+            @parallel
+            for i in 0u...n
+                scale(ys, i, 2.0)
+                println(fresh(ys[i])[0])
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var sum := 0
+            @parallel
+            for x in [1, 2, 3]
+                sum += x
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            @parallel
+            for x in [1, 2, 3]
+                return
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func append(var ys, x)
+            ys.push(x)
+        end
+
+        func main
+            var ys := new [int]
+            @parallel
+            for x in [1, 2, 3]
+                append(ys, x)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func append(var ys, x)
+            ys.push(x)
+        end
+
+        func add(var ys, x)
+            append(ys, x * 2)
+        end
+
+        func main
+            var ys := new [int]
+            @parallel
+            for x in [1, 2, 3]
+                ys.add(x)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func insert(var d, k)
+            d[k] = 'a'
+        end
+
+        func main
+            var d := {0 => 'b'}
+            @parallel
+            for x in [1, 2, 3]
+                insert(d, x)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var ys := new [int]
+            @parallel
+            for x in [1, 2, 3]
+                ys.push(x)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            @parallel
+            for k, v in {1 => 'a', 2 => 'b'}
+                println(v)
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var i := 0
+            @parallel
+            for i < 10
+                i += 1
+            end
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            @parallel(2)
+            for x in [1, 2, 3]
+                println(x)
+            end
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(simd_vector)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func dot(a : float4, b : float4)
+            return reduce_add(a * b)
+        end
+
+        func main
+            var v := new float4{1.0, 2.0, 3.0, 4.0}
+            w := new float4{2.0}
+            v += w
+            v[0] = v[3] * 2.0
+            println(dot(v, -w))
+
+            i := new int4{1, 2, 3, 4}
+            r := shuffle(i, new int4{3, 2, 1, 0})
+            println(r.reduce_max + (i & r).reduce_min)
+            println(i[3u])
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            v := new float4{1, 2, 3, 4}
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            v := new float4{1.0, 2.0}
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            v := new float4{1.0}
+            println(v < v)
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            v := new float4{1.0}
+            println(v[4])
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            v := new float4{1.0}
+            println(shuffle(v, new int2{1, 0})[0])
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            println(reduce_add(1.0))
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(variadic_print)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func main
+            x := 42
+            t := (1, 'a', ("b", 3.14), :sym)
+            print(x)
+            print("x = ", x, ", t = ", t, '\n')
+            println()
+            println(x, ' ', 1u, ' ', true)
+            println((x, x * 2), t)
+            x.println
+            t.print
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            println("a", [1, 2, 3])
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            println((1, [2]))
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            print(new float4{1.0})
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            print()
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(string_operations)
+{
+    CHECK_NO_THROW_SEMANTIC_ERROR(R"(
+        func greet(name)
+            return "Hello, " + name + "!"
+        end
+
+        func main
+            var s := greet("dachs")
+            s += " " + "bye"
+            c := s[0]
+            t := s[1..3]
+            u := s[1u...s.size]
+            n := s.size
+            b := s == t || s < u || (s, 1) >= (t, 2)
+            var d := new {string => int}
+            d[t] = 42
+            println(s, c, t, u, n, b, d[t])
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            s := "foo" - "bar"
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var s := "foo"
+            s[0] = 'b'
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            var s := "foo"
+            s *= "bar"
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            s := "foo"
+            println(s['a'..'b'])
+        end
+    )");
+
+    CHECK_THROW_SEMANTIC_ERROR(R"(
+        func main
+            s := "foo"
+            println(s[1.0])
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(statistics)
+{
+    dachs::statistics::clear();
+
+    auto t = p.parse(R"(
+        func id(x)
+            return x
+        end
+
+        func main
+            println(id(42))
+            println(id('a'))
+        end
+    )", "test_file");
+    dachs::semantics::analyze_semantics(t);
+
+    // Note:
+    // Counters are collected only when DACHS_ENABLE_STATS is defined.  Otherwise the macros
+    // evaluate nothing.
+    auto const& counters = dachs::statistics::counters();
+    if (dachs::statistics::enabled()) {
+        auto const count_of
+            = [&counters](std::string const& key) -> std::size_t
+            {
+                auto const c = counters.find(key);
+                return c == std::end(counters) ? 0u : c->second;
+            };
+        BOOST_CHECK(count_of("scope.global") >= 1u);
+        BOOST_CHECK(count_of("scope.func") >= 2u);
+        BOOST_CHECK(count_of("semantics.resolve_func.calls") >= 2u);
+
+        std::size_t num_instantiations = 0u;
+        for (auto const& c : counters) {
+            if (c.first.find("semantics.instantiation.") == 0u) {
+                num_instantiations += c.second;
+            }
+        }
+        BOOST_CHECK(num_instantiations >= 2u);
+    } else {
+        BOOST_CHECK(counters.empty());
+    }
+
+    dachs::statistics::clear();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
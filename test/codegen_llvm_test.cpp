@@ -10,11 +10,34 @@
 #include "dachs/exception.hpp"
 
 #include <string>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
 
 #include <boost/test/included/unit_test.hpp>
 
 static dachs::syntax::parser p;
 
+// Note:
+// The runtime is a part of the library linked to this test (see runtime/string.cpp)
+struct dachs_string {
+    char const* ptr;
+    std::uint64_t len;
+};
+extern "C" void __dachs_string_concat__(dachs_string *, dachs_string const*, std::uint64_t);
+extern "C" void __dachs_string_release__(dachs_string *);
+extern "C" std::uint64_t __dachs_format_float__(double, char *);
+
 #define CHECK_NO_THROW_CODEGEN_ERROR(...) do { \
             auto t = p.parse((__VA_ARGS__), "test_file"); \
             auto s = dachs::semantics::analyze_semantics(t); \
@@ -29,6 +52,44 @@ static dachs::syntax::parser p;
             BOOST_CHECK_THROW(dachs::codegen::llvmir::emit_llvm_ir(t, s, c), dachs::code_generation_error); \
         } while (false);
 
+// Note:
+// The emitted module is owned by the context.  It is valid while 'c' is alive.
+inline llvm::Module &emit_module(std::string const& code, dachs::codegen::llvmir::context &c)
+{
+    auto t = p.parse(code, "test_file");
+    auto s = dachs::semantics::analyze_semantics(t);
+    return dachs::codegen::llvmir::emit_llvm_ir(t, s, c);
+}
+
+// Note:
+// Collects direct calls which satisfy the predicate in the order of their appearance
+template<class Predicate>
+std::vector<llvm::CallInst *> collect_calls_if(llvm::Module &module, Predicate const& pred)
+{
+    std::vector<llvm::CallInst *> calls;
+    for (auto &f : module) {
+        for (auto &b : f) {
+            for (auto &i : b) {
+                auto *const call = llvm::dyn_cast<llvm::CallInst>(&i);
+                if (call && call->getCalledFunction() && pred(*call)) {
+                    calls.push_back(call);
+                }
+            }
+        }
+    }
+    return calls;
+}
+
+inline std::vector<llvm::CallInst *> collect_calls(llvm::Module &module, llvm::StringRef const callee)
+{
+    return collect_calls_if(module, [callee](llvm::CallInst const& call){ return call.getCalledFunction()->getName() == callee; });
+}
+
+inline std::size_t count_calls(llvm::Module &module, llvm::StringRef const callee)
+{
+    return collect_calls(module, callee).size();
+}
+
 BOOST_AUTO_TEST_SUITE(codegen_llvm)
 
 BOOST_AUTO_TEST_CASE(function)
@@ -1793,4 +1854,1119 @@ BOOST_AUTO_TEST_CASE(some_samples)
     )");
 }
 
+BOOST_AUTO_TEST_CASE(entry_block_allocas)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func first_or_zero(x : int) : int
+            if x > 0
+                v := (x, x + 1)
+                ret v[0]
+            end
+            ret 0
+        end
+
+        func main
+            var i := 0
+            for i < 10
+                t := (i, i + 1)
+                var u := t
+                i += u[0] - t[0] + 1
+            end
+
+            for e in [i, i + 1]
+                var e2 := e
+                var w := (e, e2)
+                println(w[1])
+            end
+
+            var s := ""
+            for s + "x" != "xxxx"
+                s += "x"
+            end
+            println(first_or_zero(i))
+        end
+    )", c);
+
+    // Note:
+    // Each lifetime of a slot ends on every path out of its scope, including the early return
+    // and the condition of 'for' evaluated on each iteration.  Slots of the same type in
+    // different scopes are reused.
+    std::unordered_map<llvm::Value *, unsigned> starts, ends;
+    bool reused = false, cond_temporaries = false;
+    for (auto &f : module.getFunctionList()) {
+        for (auto &b : f) {
+            unsigned block_starts = 0u, block_ends = 0u;
+            for (auto &i : b) {
+                if (llvm::isa<llvm::AllocaInst>(i)) {
+                    BOOST_CHECK(&b == &f.getEntryBlock());
+                }
+
+                auto *const intrinsic = llvm::dyn_cast<llvm::IntrinsicInst>(&i);
+                if (!intrinsic) {
+                    continue;
+                }
+
+                auto *const slot = intrinsic->getArgOperand(1)->stripPointerCasts();
+                if (intrinsic->getIntrinsicID() == llvm::Intrinsic::lifetime_start) {
+                    reused = reused || ++starts[slot] > 1u;
+                    ++block_starts;
+                } else if (intrinsic->getIntrinsicID() == llvm::Intrinsic::lifetime_end) {
+                    ++ends[slot];
+                    ++block_ends;
+                }
+            }
+
+            if (b.getName().startswith("while.cond")) {
+                cond_temporaries = cond_temporaries || block_starts > 0u;
+                BOOST_CHECK_EQUAL(block_starts, block_ends);
+            }
+        }
+    }
+
+    BOOST_CHECK(reused);
+    BOOST_CHECK(cond_temporaries);
+    for (auto const& start : starts) {
+        BOOST_CHECK(ends[start.first] >= start.second);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(aggregate_parameters_by_ref)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func first(t : (int, int)) : int
+            ret t[0]
+        end
+
+        func sum(a)
+            var s := 0
+            for e in a
+                s += e
+            end
+            ret s
+        end
+
+        func inc_first(var t : (int, int)) : int
+            t[0] += 1
+            ret t[0]
+        end
+
+        func main
+            var x := 1
+            println(first((x, 2)))
+            println(sum([x, 2, 3]))
+            println(inc_first((x, 2)))
+        end
+    )", c);
+
+    unsigned num_ref_params = 0u;
+    for (auto &f : module.getFunctionList()) {
+        for (auto &a : f.getArgumentList()) {
+            if (a.getType()->isPointerTy() && a.getType()->getPointerElementType()->isAggregateType()) {
+                BOOST_CHECK(a.hasNoAliasAttr());
+                BOOST_CHECK(a.hasNoCaptureAttr());
+                ++num_ref_params;
+            }
+        }
+    }
+
+    // Note: 'var' parameter is passed by value
+    BOOST_CHECK_EQUAL(num_ref_params, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(by_ref_parameters_are_not_readnone)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func sum(a)
+            var s := 0
+            for e in a
+                s += e
+            end
+            ret s
+        end
+
+        func main
+            var a := [1, 2, 3, 4]
+            x := sum(a)
+            a[0] = 10
+            y := sum(a)
+            println(x + y)
+        end
+    )", c);
+
+    // Note:
+    // 'sum' reads the caller's array through its parameter.  If it were readnone, the 2nd call
+    // could be replaced with the result of the 1st call across 'a[0] = 10'.
+    unsigned num_ref_funcs = 0u;
+    for (auto &f : module.getFunctionList()) {
+        if (f.isDeclaration() || f.arg_empty() || !f.arg_begin()->getType()->isPointerTy()) {
+            continue;
+        }
+        BOOST_CHECK(!f.doesNotAccessMemory());
+        BOOST_CHECK(f.onlyReadsMemory());
+        ++num_ref_funcs;
+    }
+    BOOST_CHECK_EQUAL(num_ref_funcs, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(trapping_lookup_is_not_readonly)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func check(d, k)
+            v := d[k]
+        end
+
+        func main
+            d := {1 => 2}
+            check(d, 3)
+        end
+    )", c);
+
+    // Note:
+    // Looking up a missing key aborts.  If 'check' were readonly, the call whose result is
+    // unused could be eliminated with the abort.
+    auto const lookups = collect_calls(module, "__dachs_dict_at__");
+    BOOST_REQUIRE(!lookups.empty());
+    for (auto const* const call : lookups) {
+        BOOST_CHECK(!call->getParent()->getParent()->onlyReadsMemory());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(aggregate_return_via_sret)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func make_large(x)
+            ret x, x + 1, x + 2, x + 3
+        end
+
+        func make_array(x)
+            ret [x, x, x, x, x]
+        end
+
+        func make_small(x)
+            ret x, x
+        end
+
+        func main
+            var x := 1
+            println(make_large(x)[3])
+            println(make_array(x)[4])
+            println(make_small(x)[1])
+        end
+    )", c);
+
+    unsigned num_sret_funcs = 0u;
+    for (auto &f : module.getFunctionList()) {
+        if (f.arg_empty() || !f.arg_begin()->hasStructRetAttr()) {
+            continue;
+        }
+        BOOST_CHECK(f.getReturnType()->isVoidTy());
+        BOOST_CHECK(!f.doesNotAccessMemory());
+        ++num_sret_funcs;
+    }
+
+    // Note: Small tuple is returned as a first-class value
+    BOOST_CHECK_EQUAL(num_sret_funcs, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(aggregate_copy_elision)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func make(x)
+            ret x, x + 1, x + 2, x + 3
+        end
+
+        func main
+            var x := 1
+            var t := (x, 2)
+            var u := [x, 2, 3]
+            var v := make(x)
+            println(t[0] + u[0] + v[3])
+        end
+    )", c);
+
+    auto *const main_func = module.getFunction("main");
+    BOOST_REQUIRE(main_func);
+
+    // Note: Temporaries are constructed in the storage of variables
+    unsigned num_memcpy = 0u;
+    for (auto &b : *main_func) {
+        for (auto &i : b) {
+            if (llvm::isa<llvm::MemCpyInst>(&i)) {
+                ++num_memcpy;
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(num_memcpy, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(for_stmt_in_place_iteration)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func sum(a)
+            var s := 0
+            for e in a
+                s += e
+            end
+            ret s
+        end
+
+        func main
+            for e in [1, 2, 3]
+                println(e)
+            end
+
+            for e in [1, 2, 3]
+                println(e)
+            end
+
+            var x := 1
+            println(sum([x, 2, 3]))
+        end
+    )", c);
+
+    // Note: Constant arrays share the storage
+    unsigned num_array_globals = 0u;
+    for (auto &g : module.getGlobalList()) {
+        auto *const t = g.getType()->getPointerElementType();
+        if (t->isArrayTy() && !t->getArrayElementType()->isIntegerTy(8u)) {
+            ++num_array_globals;
+        }
+    }
+    BOOST_CHECK_EQUAL(num_array_globals, 1u);
+
+    for (auto &f : module.getFunctionList()) {
+        for (auto &b : f) {
+            for (auto &i : b) {
+                if (auto *const a = llvm::dyn_cast<llvm::AllocaInst>(&i)) {
+                    if (a->getName().startswith("for.i")) {
+                        BOOST_CHECK(a->getAllocatedType()->isIntegerTy(64u));
+                    }
+                }
+
+                // Note: Range is not copied
+                BOOST_CHECK(!llvm::isa<llvm::MemCpyInst>(&i));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dynamic_array)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func sum(a)
+            var s := 0
+            for e in a
+                s += e
+            end
+            ret s
+        end
+
+        func main
+            var n := 10
+            var a := new [int]{n}
+            var b := new [float]{n, 1.0}
+            var c := new [int]
+
+            var i := 0
+            for i < n
+                push(c, i)
+                a[i] = i * 2
+                i += 1
+            end
+
+            println(a[3])
+            println(c.size)
+            println(sum(c))
+
+            for e in b
+                println(e)
+            end
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(dynamic_array_copies_share_header)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func main
+            var n := 2u
+            var a := new [int]{n}
+            var b := a
+            push(b, 42)
+            println(a.size)
+            println(a[2])
+        end
+    )", c);
+
+    // Note:
+    // 'a' and 'b' are handles of the same header.  push() grows the elements through the header,
+    // so 'a' never refers to the elements reallocated for 'b'.
+    auto *const new_func = module.getFunction("__dachs_array_new__");
+    BOOST_REQUIRE(new_func);
+    BOOST_CHECK_EQUAL(new_func->getNumUses(), 1u);
+
+    auto *const grow_func = module.getFunction("__dachs_array_grow__");
+    BOOST_REQUIRE(grow_func);
+    BOOST_CHECK(grow_func->arg_begin()->getType()->getPointerElementType()->isPointerTy());
+    for (auto const* const call : collect_calls(module, "__dachs_array_grow__")) {
+        BOOST_CHECK(llvm::isa<llvm::AllocaInst>(call->getArgOperand(0)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dictionary)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func count(words)
+            var counts := new {string => uint}
+            for w in words
+                counts[w] += 1u
+            end
+            ret counts
+        end
+
+        func main
+            var d := {1 => 'a', 2 => 'b', 3 => 'c'}
+            d[4] = 'd'
+            println(d[2])
+            println(d.size)
+
+            for k, v in d
+                println(k)
+                println(v)
+            end
+
+            var counts := count(["foo", "bar", "foo"])
+            println(counts["foo"])
+
+            var f := {3.14 => :pi, 2.71 => :e}
+            for _, v in f
+                println(v)
+            end
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(range)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func sum(r)
+            var s := 0
+            for i in r
+                s += i
+            end
+            ret s
+        end
+
+        func main
+            var n := 100
+            println(sum(1..n))
+            println(sum((0...n).step(7)))
+            println(sum(n..1))
+
+            for var i in 10u...20u
+                i *= 2u
+                println(i)
+            end
+
+            for c in 'a'..'z'
+                print(c)
+            end
+
+            for _ in -3..3
+                println("foo")
+            end
+        end
+    )");
+}
+
+BOOST_AUTO_TEST_CASE(range_full_boundary)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func main
+            max := 0u - 1u
+
+            for i in 0u..max
+                println(i)
+            end
+
+            for i in max..max
+                println(i)
+            end
+        end
+    )", c);
+
+    // Note:
+    // The full range has 2^64 iterations.  The number doesn't fit in 64bit, so the loop exits
+    // when the counter reaches the last index (2^64 - 1) instead of comparing it with the number.
+    // The range of one element exits when the counter is 0.
+    auto *const main_func = module.getFunction("main");
+    BOOST_REQUIRE(main_func);
+    unsigned num_last_index_checks = 0u;
+    unsigned num_single_checks = 0u;
+    for (auto &b : *main_func) {
+        for (auto &i : b) {
+            auto *const cmp = llvm::dyn_cast<llvm::ICmpInst>(&i);
+            if (!cmp) {
+                continue;
+            }
+            BOOST_CHECK(cmp->getPredicate() != llvm::ICmpInst::ICMP_ULT);
+            if (auto *const last = llvm::dyn_cast<llvm::ConstantInt>(cmp->getOperand(1))) {
+                if (last->isAllOnesValue()) {
+                    ++num_last_index_checks;
+                } else if (last->isZero()) {
+                    ++num_single_checks;
+                }
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(num_last_index_checks, 1u);
+    BOOST_CHECK_EQUAL(num_single_checks, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(char_range_is_signed)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func span(a : char, b : char)
+            for c in a..b
+                print(c)
+            end
+        end
+
+        func main
+            span('a', 'z')
+        end
+    )", c);
+
+    // Note:
+    // char is signed as int.  Its bounds are sign-extended and compared as signed values.
+    auto *const span_func = module.getFunction("span");
+    BOOST_REQUIRE(span_func);
+    unsigned num_sexts = 0u, num_signed_cmps = 0u;
+    for (auto &b : *span_func) {
+        for (auto &i : b) {
+            if (auto *const cast = llvm::dyn_cast<llvm::CastInst>(&i)) {
+                if (cast->getSrcTy()->isIntegerTy(8u)) {
+                    BOOST_CHECK(!llvm::isa<llvm::ZExtInst>(cast));
+                    if (llvm::isa<llvm::SExtInst>(cast)) {
+                        ++num_sexts;
+                    }
+                }
+            } else if (auto *const cmp = llvm::dyn_cast<llvm::ICmpInst>(&i)) {
+                if (cmp->isSigned()) {
+                    ++num_signed_cmps;
+                }
+            }
+        }
+    }
+    BOOST_CHECK(num_sexts >= 2u);
+    BOOST_CHECK(num_signed_cmps >= 2u);
+}
+
+BOOST_AUTO_TEST_CASE(switch_inst)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func dispatch(op, x)
+            case op
+            when :inc
+                ret x + 1
+            when :dec, :decrement
+                ret x - 1
+            when :inc
+                ret x + 2
+            else
+                ret x
+            end
+        end
+
+        func classify(c)
+            case c
+            when 'a', 'e', 'i', 'o', 'u'
+                ret 1
+            when ' '
+                ret 2
+            end
+            ret 0
+        end
+
+        func main
+            var i := 3
+            case i
+            when 1 + 1
+                println(:two)
+            when 0, 1, 3
+                println(i)
+            when -1
+                println(:negative)
+            end
+
+            var j := 4
+            case i
+            when j
+                println(j)
+            when 1
+                println(i)
+            end
+
+            println(dispatch(:dec, 10))
+            println(classify('e'))
+        end
+    )", c);
+
+    auto const count_switch_insts
+        = [&module](char const* const name)
+        {
+            auto *const f = module.getFunction(name);
+            BOOST_REQUIRE(f);
+            unsigned num_switch = 0u;
+            for (auto &b : *f) {
+                if (llvm::isa<llvm::SwitchInst>(b.getTerminator())) {
+                    ++num_switch;
+                }
+            }
+            return num_switch;
+        };
+
+    // Note: Switch statement which has a non-constant 'when' value is lowered to comparisons
+    BOOST_CHECK_EQUAL(count_switch_insts("main"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(tail_call)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func converge(x : float, iters : float) : float
+            ret iters if iters > 255.0 || x >= 4.0
+            ret converge(x * x + 0.25, iters + 1.0)
+        end
+
+        func count_down(n : int)
+            if n > 0
+                println(n)
+                count_down(n - 1)
+            end
+        end
+
+        func sum_to(n : int, acc : int) : int
+            if n == 0
+                ret acc
+            else
+                ret sum_to(n - 1, acc + n)
+            end
+        end
+
+        func fib(n : int) : int
+            ret n if n <= 1
+            ret fib(n - 1) + fib(n - 2)
+        end
+
+        func main
+            println(converge(0.0, 0.0))
+            count_down(100000000)
+            println(sum_to(100000000, 0))
+            println(fib(10))
+        end
+    )", c);
+
+    // Note: Only non-tail recursive calls in fib() remain
+    auto const self_calls = collect_calls_if(module, [](llvm::CallInst const& call){ return call.getCalledFunction() == call.getParent()->getParent(); });
+    for (auto const* const call : self_calls) {
+        BOOST_CHECK(!call->isTailCall());
+    }
+    BOOST_CHECK_EQUAL(self_calls.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(block_inlining)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func step_to(var first, last, block)
+            for first <= last
+                block(first)
+                first += 1
+            end
+        end
+
+        func main
+            val offset := 42
+            1.step_to 10 do |i|
+                println(i + offset)
+            end
+
+            step_to(1, 3) do |i|
+                1.step_to i do |j|
+                    println(i * j)
+                end
+            end
+        end
+    )", c);
+
+    // Note: Blocks and the functions receiving them are inlined into main
+    unsigned num_defined_funcs = 0u;
+    for (auto &f : module) {
+        if (!f.isDeclaration()) {
+            ++num_defined_funcs;
+        }
+    }
+    BOOST_CHECK_EQUAL(num_defined_funcs, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(escape_analysis)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func sum(a)
+            var s := 0
+            for e in a
+                s += e
+            end
+            ret s
+        end
+
+        func make(n)
+            a := new [int]{n}
+            ret a
+        end
+
+        func main
+            n := 16u
+            var local := new [int]{n}
+            var i := 0
+            for i < 16
+                local[i] = i * i
+                i += 1
+            end
+            println(local[15])
+            println(local.size)
+
+            var pushed := new [int]{n}
+            push(pushed, 42)
+
+            passed := new [int]{n, 1}
+            println(sum(passed))
+
+            println(make(4u).size)
+
+            var captured := new [int]{n}
+            f := -> x in x + captured[0]
+            println(f(3))
+        end
+    )", c);
+
+    // Note:
+    // Sizes are not literals so that all arrays are dynamically sized.  'n' is immutable, so its
+    // value is still a constant and only the array which never escapes from main is allocated
+    // in the stack.
+    BOOST_CHECK_EQUAL(count_calls(module, "__dachs_array_alloc__"), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(loop_metadata)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func saxpy(a, xs, var ys)
+            var i := 0u
+            @vectorize(8) @unroll(2)
+            for x in xs
+                ys[i] += a * x
+                i += 1u
+            end
+        end
+
+        func main
+            xs := new [float]{1024u, 1.0}
+            var ys := new [float]{1024u, 2.0}
+            saxpy(3.0, xs, ys)
+
+            var sum := 0.0
+            for y in ys
+                sum += y
+            end
+
+            var i := 0
+            @unroll(1)
+            for i < 10
+                i += 1
+            end
+            println(sum)
+        end
+    )", c);
+
+    // Note: Only loops annotated with hints have 'llvm.loop' metadata on their back edges
+    unsigned num_loops_with_metadata = 0u;
+    for (auto &f : module) {
+        for (auto &b : f) {
+            auto *const br = llvm::dyn_cast<llvm::BranchInst>(b.getTerminator());
+            if (br && br->getMetadata("llvm.loop")) {
+                auto *const loop_id = br->getMetadata("llvm.loop");
+                BOOST_CHECK_EQUAL(loop_id->getOperand(0), loop_id);
+                ++num_loops_with_metadata;
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(num_loops_with_metadata, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(simd_vector)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func axpy(a : float, x : float4, y : float4)
+            return new float4{a} * x + y
+        end
+
+        func main
+            var v := new float4{1.0, 2.0, 3.0, 4.0}
+            v[1] = 0.5
+            v = axpy(2.0, v, -v)
+            println(v[1] + v.reduce_mul)
+
+            var i := new int8{1}
+            i = shuffle(i << new int8{2}, new int8{7, 6, 5, 4, 3, 2, 1, 0})
+            println(reduce_min(i) + reduce_max(i % new int8{3}))
+        end
+    )");
+
+    CHECK_THROW_CODEGEN_ERROR(R"(
+        func reverse(v : int4, mask : int4)
+            return shuffle(v, mask)
+        end
+
+        func main
+            println(reverse(new int4{1}, new int4{3, 2, 1, 0})[0])
+        end
+    )");
+
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func hsum(v : float4)
+            return reduce_add(v)
+        end
+
+        func main
+            println(hsum(new float4{1.0, 2.0, 3.0, 4.0}))
+        end
+    )", c);
+
+    // Note: 4 lanes are reduced by 2 shuffles and one lane is extracted at last
+    unsigned num_shuffles = 0u, num_extracts = 0u;
+    for (auto &f : module) {
+        for (auto &b : f) {
+            for (auto &i : b) {
+                if (llvm::isa<llvm::ShuffleVectorInst>(&i)) {
+                    ++num_shuffles;
+                } else if (llvm::isa<llvm::ExtractElementInst>(&i)) {
+                    ++num_extracts;
+                }
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(num_shuffles, 2u);
+    BOOST_CHECK_EQUAL(num_extracts, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_for)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func scale(a : float, xs : [float], ys : [float])
+            @parallel
+            for i in 0u...xs.size
+                ys[i] = a * xs[i]
+            end
+        end
+
+        func main
+            xs := [1.0, 2.0, 3.0, 4.0]
+            var ys := new [float]{4u}
+            @parallel
+            for x in xs
+                println(x + 1.0)
+            end
+            @parallel
+            for i in 0u...4u
+                ys[i] = xs[i] * 2.0
+            end
+            var zs := new [float]{100u, 0.5}
+            scale(2.0, zs, zs)
+            @parallel
+            for z in zs
+                println(z)
+            end
+        end
+    )");
+
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func main
+            n := 1000u
+            xs := new [int]{n, 1}
+            var ys := new [int]{n}
+            k := 3
+            @parallel
+            for i in 0u...n
+                ys[i] = xs[i] * k
+            end
+            println(ys[0])
+        end
+    )", c);
+
+    // Note: The body is outlined and passed to the runtime
+    unsigned num_bodies = 0u;
+    for (auto &f : module) {
+        if (f.getName().endswith(".pfor")) {
+            ++num_bodies;
+        }
+    }
+    BOOST_CHECK_EQUAL(num_bodies, 1u);
+    BOOST_CHECK_EQUAL(count_calls(module, "__dachs_parallel_for__"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(variadic_print)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func pair(a, b)
+            return (a, b)
+        end
+
+        func main
+            x := 42
+            var f := 3.14
+            t := (1, 'a', ("b", f), :sym)
+            print(x)
+            print("x = ", x, ", t = ", t, '\n')
+            println()
+            println(x, ' ', 1u, ' ', true, ' ', f)
+            println((x, x * 2), t, pair(x, "foo"))
+            x.println
+            t.print
+        end
+    )");
+
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func main
+            println("answer", ' ', 42, " is ", (true, :sym, 1u))
+            x := 42
+            println("x = ", x, '!')
+        end
+    )", c);
+
+    // Note:
+    // The 1st line consists of literals and is written by one call.  The 2nd line is written
+    // by one call for each piece and only the last one ends the line.
+    std::vector<std::string> callees;
+    for (auto const* const call : collect_calls_if(module, [](llvm::CallInst const& call){ return call.getCalledFunction()->getName().startswith("__dachs_print"); })) {
+        callees.push_back(call->getCalledFunction()->getName().str());
+    }
+    std::vector<std::string> const expected = {
+        "__dachs_println_string__",
+        "__dachs_print_string__",
+        "__dachs_print_int__",
+        "__dachs_println_string__",
+    };
+    BOOST_CHECK(callees == expected);
+}
+
+BOOST_AUTO_TEST_CASE(string_operations)
+{
+    CHECK_NO_THROW_CODEGEN_ERROR(R"(
+        func greet(name)
+            return "Hello, " + name + "!"
+        end
+
+        func main
+            var s := greet("dachs")
+            for _ in 0..9
+                s += " " + s[0..1]
+            end
+            c := s[0]
+            t := s[1..3]
+            u := s[1u...s.size]
+            b := s == t || s < u || (s, 1) >= (t, 2)
+            var d := {"foo" => 1, "bar" => 2}
+            d[t] = 42
+            println(s, c, t, u, s.size, b, d["foo"], s.__type)
+            case s
+            when "foo", "bar"
+                println("foobar")
+            end
+        end
+    )");
+
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func main
+            a := "foo"
+            var s := a + ", " + a + "!"
+            s += a[0...1] + "?"
+            println(s)
+        end
+    )", c);
+
+    // Note:
+    // A chain of concatenations is lowered to one runtime call.  Slicing calls nothing.
+    BOOST_CHECK_EQUAL(count_calls(module, "__dachs_string_concat__"), 2u);
+
+    // Note:
+    // The result is written through the 1st argument instead of being returned by value
+    auto *const concat_func = module.getFunction("__dachs_string_concat__");
+    BOOST_REQUIRE(concat_func);
+    BOOST_CHECK(concat_func->getReturnType()->isVoidTy());
+    BOOST_CHECK_EQUAL(concat_func->arg_size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE(string_append_in_place)
+{
+    // Note:
+    // 's += t' in a loop appends to the buffer of 's' in place.  The buffer is reallocated only
+    // when it is exhausted and the capacity is doubled then.  So the number of buffers (and
+    // the memory for them) grows logarithmically with the length.
+    dachs_string s = {nullptr, 0u};
+    dachs_string const t = {"x", 1u};
+    std::unordered_set<char const*> buffers;
+
+    std::uint64_t const n = 100000u;
+    for (std::uint64_t i = 0u; i < n; ++i) {
+        dachs_string const pieces[] = {s, t};
+        __dachs_string_concat__(&s, pieces, 2u);
+        buffers.insert(s.ptr);
+    }
+
+    BOOST_CHECK_EQUAL(s.len, n);
+    BOOST_CHECK(s.ptr[0] == 'x' && s.ptr[n - 1u] == 'x');
+    BOOST_CHECK(buffers.size() <= 20u);
+
+    __dachs_string_release__(&s);
+    BOOST_CHECK(!s.ptr && s.len == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(string_concat_ownership)
+{
+    dachs_string const a = {"foo", 3u};
+    dachs_string const b = {"bar", 3u};
+
+    // Note:
+    // 'u = s + b' appends to the buffer of 's' in place.  The buffer is shared by the results
+    // and remains until both of them are released.
+    dachs_string s = {nullptr, 0u};
+    dachs_string u = {nullptr, 0u};
+    {
+        dachs_string const pieces[] = {a, a};
+        __dachs_string_concat__(&s, pieces, 2u);
+    }
+    {
+        dachs_string const pieces[] = {s, b};
+        __dachs_string_concat__(&u, pieces, 2u);
+    }
+    BOOST_CHECK(u.ptr == s.ptr);
+    __dachs_string_release__(&s);
+    BOOST_CHECK_EQUAL(std::string(u.ptr, u.len), "foofoobar");
+    __dachs_string_release__(&u);
+
+    // Note:
+    // 't = a + b' in a loop releases the previous result.  Buffers are freed and allocated
+    // again, so only a few addresses are used with the allocator reusing freed memory.
+    dachs_string t = {nullptr, 0u};
+    char const* used[64];
+    std::size_t num_used = 0u;
+    for (auto i = 0; i < 10000; ++i) {
+        dachs_string const pieces[] = {a, b};
+        __dachs_string_concat__(&t, pieces, 2u);
+        if (std::find(used, used + num_used, t.ptr) == used + num_used) {
+            BOOST_REQUIRE(num_used < 64u);
+            used[num_used++] = t.ptr;
+        }
+    }
+    BOOST_CHECK_EQUAL(std::string(t.ptr, t.len), "foobar");
+    __dachs_string_release__(&t);
+}
+
+BOOST_AUTO_TEST_CASE(string_concat_owner_slot)
+{
+    dachs::codegen::llvmir::context c;
+    auto &module = emit_module(R"(
+        func exclaim(s)
+            ret s + "!"
+        end
+
+        func main
+            a := "foo"
+            var t := ""
+            for _ in 0..9
+                t = a + "bar"
+                println(t)
+            end
+            println(exclaim(a))
+        end
+    )", c);
+
+    // Note:
+    // 't' never escapes from main.  The concatenation assigned to it owns the result and
+    // releases it at the end of main.  The result returned from exclaim() is never released.
+    auto const releases = collect_calls(module, "__dachs_string_release__");
+    for (auto const* const call : releases) {
+        BOOST_CHECK(llvm::isa<llvm::ReturnInst>(call->getNextNode()));
+        BOOST_CHECK(llvm::isa<llvm::AllocaInst>(call->getArgOperand(0)));
+        BOOST_CHECK(call->getParent()->getParent()->getName() == "main");
+    }
+    BOOST_CHECK_EQUAL(releases.size(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(float_formatting)
+{
+    auto const format = [](double const d)
+    {
+        char buf[32];
+        return std::string(buf, __dachs_format_float__(d, buf));
+    };
+
+    // Note: Shortest digits which are read back to the same value
+    auto const check_round_trip = [&format](double const d)
+    {
+        auto const s = format(d);
+        auto const read = std::strtod(s.c_str(), nullptr);
+        BOOST_CHECK_MESSAGE(std::memcmp(&read, &d, sizeof(d)) == 0, s);
+    };
+
+    BOOST_CHECK_EQUAL(format(0.1), "0.1");
+    BOOST_CHECK_EQUAL(format(0.25), "0.25");
+    BOOST_CHECK_EQUAL(format(1e16), "1e+16");
+    BOOST_CHECK_EQUAL(format(1.5e-7), "1.5e-07");
+    BOOST_CHECK_EQUAL(format(9007199254740991.0), "9007199254740991");
+    BOOST_CHECK_EQUAL(format(9007199254740992.0), "9007199254740992");
+    BOOST_CHECK_EQUAL(format(9007199254740994.0), "9007199254740994");
+    BOOST_CHECK_EQUAL(format(std::numeric_limits<double>::max()), "1.7976931348623157e+308");
+    BOOST_CHECK_EQUAL(format(std::numeric_limits<double>::min()), "2.2250738585072014e-308");
+    BOOST_CHECK_EQUAL(format(std::numeric_limits<double>::denorm_min()), "5e-324");
+    BOOST_CHECK_EQUAL(format(0.0), "0");
+    BOOST_CHECK_EQUAL(format(-0.0), "-0");
+    BOOST_CHECK_EQUAL(format(std::numeric_limits<double>::infinity()), "inf");
+    BOOST_CHECK_EQUAL(format(-std::numeric_limits<double>::infinity()), "-inf");
+    BOOST_CHECK_EQUAL(format(std::numeric_limits<double>::quiet_NaN()), "nan");
+
+    double const values[] = {
+        0.1, 0.2, 0.3, 1.0 / 3.0, 2.0 / 3.0, 1e16, 1e23, 5e-324, 1e-323, 2.225073858507201e-308,
+        std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+        std::nextafter(1.0, 2.0), std::nextafter(1.0, 0.0), 4.35, 123456.789, -0.0, -1.5e300,
+        9007199254740991.0, 9007199254740992.0, 9007199254740994.0,
+    };
+    for (auto const d : values) {
+        check_round_trip(d);
+    }
+
+    // Note: Powers of 2 have unequal gaps to their neighbors
+    for (auto e = -1074; e <= 1023; ++e) {
+        check_round_trip(std::ldexp(1.0, e));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
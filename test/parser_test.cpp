@@ -1628,6 +1628,51 @@ BOOST_AUTO_TEST_CASE(while_statement)
         )"));
 }
 
+BOOST_AUTO_TEST_CASE(loop_hints)
+{
+    BOOST_CHECK_NO_THROW(parse_and_validate(R"(
+        func main
+            @vectorize
+            for e in a
+                foo(e)
+            end
+
+            @vectorize(8) @unroll(4)
+            for e in a
+            end
+
+            @unroll(1)
+            for i < 10
+                i += 1
+            end
+        end
+        )"));
+
+    CHECK_PARSE_THROW(R"(
+        func main
+            @vectorize
+        end
+    )");
+
+    auto const ast = p.parse(R"(
+        func main
+            @vectorize(8)
+            @unroll
+            for e in a
+            end
+        end
+    )", "test_file");
+
+    using namespace dachs::ast::node;
+    auto const main_def = boost::get<function_definition>(ast.root->definitions[0]);
+    auto const for_ = boost::get<for_stmt>(main_def->body->value[0]);
+    BOOST_REQUIRE_EQUAL(for_->hints.size(), 2u);
+    BOOST_CHECK_EQUAL(for_->hints[0].first, "vectorize");
+    BOOST_CHECK(for_->hints[0].second && *for_->hints[0].second == 8u);
+    BOOST_CHECK_EQUAL(for_->hints[1].first, "unroll");
+    BOOST_CHECK(!for_->hints[1].second);
+}
+
 BOOST_AUTO_TEST_CASE(function_invocation)
 {
     BOOST_CHECK_NO_THROW(parse_and_validate(R"(